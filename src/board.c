@@ -0,0 +1,143 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <float.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "heuristic.h"
+#include "board.h"
+
+/* The slot of an island. */
+typedef struct {
+  /* The published solution. */
+  Path* path;
+  /* The cost of the published solution, read without the lock. */
+  _Atomic double cost;
+  /* The lock of the published solution. */
+  pthread_mutex_t lock;
+} Slot;
+
+/* The board structure. */
+struct _Board {
+  /* The number of islands. */
+  int n;
+  /* The islands every island migrates from. */
+  Topology topology;
+  /* The slots of the islands. */
+  Slot* slots;
+};
+
+/* Returns the island another island migrates from. */
+static int source(Board*, int);
+
+/* Creates a new Board. */
+Board* board_new(Instance* instance, int n, Topology topology) {
+  int i;
+  /* Heap allocation. */
+  Board* board = malloc(sizeof(struct _Board));
+  board->slots = malloc(sizeof(Slot)*n);
+
+  /* Attribute copy. */
+  board->n        = n;
+  board->topology = topology;
+
+  /* Empty slots. */
+  for (i = 0; i < n; ++i) {
+    (board->slots+i)->path = path_new(instance, 0);
+    atomic_init(&(board->slots+i)->cost, DBL_MAX);
+    pthread_mutex_init(&(board->slots+i)->lock, NULL);
+  }
+  return board;
+}
+
+/* Frees the memory used by the board. */
+void board_free(Board* board) {
+  int i;
+  for (i = 0; i < board->n; ++i) {
+    path_free((board->slots+i)->path);
+    pthread_mutex_destroy(&(board->slots+i)->lock);
+  }
+  free(board->slots);
+  free(board);
+}
+
+/* Publishes a solution in the slot of an island. */
+void board_publish(Board* board, int island, Path* path) {
+  Slot* slot = board->slots + island;
+  double cost = path_cost_function(path);
+
+  if (cost >= atomic_load(&slot->cost))
+    return;
+  pthread_mutex_lock(&slot->lock);
+  path_copy_to(slot->path, path);
+  atomic_store(&slot->cost, cost);
+  pthread_mutex_unlock(&slot->lock);
+}
+
+/* Migrates a solution to an island. */
+int board_migrate(Board* board, int island, Path* path) {
+  int i = source(board, island), copied;
+  Slot* slot;
+  double cost;
+
+  if (i < 0)
+    return 0;
+  slot = board->slots + i;
+  cost = path_cost_function(path);
+  if (atomic_load(&slot->cost) >= cost)
+    return 0;
+  /* The slot may have been retired since, so check it again. */
+  pthread_mutex_lock(&slot->lock);
+  copied = atomic_load(&slot->cost) < cost;
+  if (copied)
+    path_copy_to(path, slot->path);
+  pthread_mutex_unlock(&slot->lock);
+  return copied;
+}
+
+/* Retires the solution of an island whose seed finished. */
+void board_retire(Board* board, int island) {
+  Slot* slot = board->slots + island;
+
+  pthread_mutex_lock(&slot->lock);
+  atomic_store(&slot->cost, DBL_MAX);
+  pthread_mutex_unlock(&slot->lock);
+}
+
+/* Returns the island another island migrates from: its
+   predecessor in the ring, or the island with the best
+   published solution; or -1 if there is none. */
+static int source(Board* board, int island) {
+  int i, best = -1;
+  double cost, c = DBL_MAX;
+
+  if (board->n < 2)
+    return -1;
+  if (board->topology == TOPOLOGY_RING)
+    return (island + board->n - 1) % board->n;
+  for (i = 0; i < board->n; ++i)
+    if (i != island
+        && (cost = atomic_load(&(board->slots+i)->cost)) < c) {
+      c = cost;
+      best = i;
+    }
+  return best;
+}
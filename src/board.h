@@ -0,0 +1,65 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/**
+ * Creates a new Board, where the islands of an island model
+ * publish their best solutions. Every island owns a slot that
+ * only it writes; the other islands read it when they migrate.
+ * @param instance the shared instance.
+ * @param n the number of islands, one per worker.
+ * @param topology the islands every island migrates from.
+ */
+Board* board_new(Instance* instance, int n, Topology topology);
+
+/**
+ * Frees the memory used by the board.
+ * @param board the board.
+ */
+void board_free(Board* board);
+
+/**
+ * Publishes a solution in the slot of an island.
+ * @param board the board.
+ * @param island the island.
+ * @param path the solution.
+ */
+void board_publish(Board* board, int island, Path* path);
+
+/**
+ * Migrates a solution to an island: the solution of its
+ * predecessor in the ring, or the best one of the board, is
+ * copied into the given path if it is better.
+ * @param board the board.
+ * @param island the island.
+ * @param path the solution of the island.
+ * @return 1 if the solution was copied; 0, otherwise.
+ */
+int board_migrate(Board* board, int island, Path* path);
+
+/**
+ * Retires the solution of an island whose seed finished: its
+ * slot is emptied until the next seed of the island publishes.
+ * @param board the board.
+ * @param island the island.
+ */
+void board_retire(Board* board, int island);
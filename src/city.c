@@ -23,7 +23,6 @@
 
 #include "city.h"
 
-#define EARTH_RADIUS 6373000
 #define _USE_MATH_DEFINES
 
 /* The city structure. */
@@ -49,10 +48,16 @@ City* city_new(int id, char* name,
   city->id = id;
   city->x = x;
   city->y = y;
-  city->country = malloc(strlen(country)+1);
-  strcpy(city->country, country);
-  city->name = malloc(strlen(name)+1);
-  strcpy(city->name, name);
+  city->country = 0;
+  city->name = 0;
+  if (country) {
+    city->country = malloc(strlen(country)+1);
+    strcpy(city->country, country);
+  }
+  if (name) {
+    city->name = malloc(strlen(name)+1);
+    strcpy(city->name, name);
+  }
   return city;
 }
 
@@ -140,9 +145,11 @@ int city_cmp(City* c_1, City* c_2) {
     return 0;
   if (abs(c_1->y - c_2->y) >= 0.00016)
     return 0;
-  if (strcmp(c_1->country, c_2->country) != 0)
+  if (!c_1->country != !c_2->country ||
+      (c_1->country && strcmp(c_1->country, c_2->country) != 0))
     return 0;
-  if (strcmp(c_1->name, c_2->name) != 0)
+  if (!c_1->name != !c_2->name ||
+      (c_1->name && strcmp(c_1->name, c_2->name) != 0))
     return 0;
   return 1;
 }
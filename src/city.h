@@ -21,11 +21,14 @@
 
 #include "heuristic.h"
 
+/* The radius of the Earth used by `city_distance`. */
+#define EARTH_RADIUS 6373000
+
 /**
  * Creates a new City.
  * @param id the id of the city.
- * @param name the name of the city.
- * @param country the country of the city.
+ * @param name the name of the city, or NULL if unknown.
+ * @param country the country of the city, or NULL if unknown.
  * @param x the x coordinate of the city.
  * @param y the y coordinate of the city.
  */
@@ -0,0 +1,229 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+
+#include "cpu.h"
+
+/* Returns the number of processors of the affinity mask. */
+int cpu_count_mask() {
+  cpu_set_t set;
+  int n;
+
+  if (sched_getaffinity(0, sizeof(set), &set))
+    return 1;
+  n = CPU_COUNT(&set);
+  return n > 0 ? n : 1;
+}
+
+/* Returns the number of processors the process can use. */
+int cpu_count() {
+  int n = cpu_count_mask();
+  int q = cpu_cgroup_quota("/proc/self/cgroup", "/proc/self/mountinfo");
+  return q && q < n ? q : n;
+}
+
+/* Returns 1 if a comma-separated list holds a token. */
+static int has_token(const char* list, const char* token) {
+  size_t n = strlen(token);
+
+  while (list) {
+    if (!strncmp(list, token, n) && (!list[n] || list[n] == ','))
+      return 1;
+    if ((list = strchr(list, ',')))
+      ++list;
+  }
+  return 0;
+}
+
+/* Finds the cgroup of the process that holds the cpu controller,
+   from a file in the format of /proc/self/cgroup: the v1
+   hierarchy with the cpu controller, or else the v2 one. The
+   path is written in path; returns the version, or 0. */
+static int cgroup_find(const char* cgroup, char* path, size_t size) {
+  char line[PATH_MAX + 64], *controllers, *p;
+  int version = 0;
+  FILE* f;
+
+  if (!(f = fopen(cgroup, "r")))
+    return 0;
+  while (version != 1 && fgets(line, sizeof(line), f)) {
+    line[strcspn(line, "\n")] = 0;
+    if (!(controllers = strchr(line, ':')))
+      continue;
+    *controllers++ = 0;
+    if (!(p = strchr(controllers, ':')))
+      continue;
+    *p++ = 0;
+    if (has_token(controllers, "cpu"))
+      version = 1;
+    else if (!*controllers && !strcmp(line, "0"))
+      version = 2;
+    else
+      continue;
+    snprintf(path, size, "%s", p);
+  }
+  fclose(f);
+  return version;
+}
+
+/* Finds the mount of a cgroup hierarchy, from a file in the format
+   of /proc/self/mountinfo. The root of the mount is written in
+   root and its mount point in mount; returns 1 if it is found. */
+static int cgroup_mount(const char* mountinfo, int version,
+                        char* root, char* mount) {
+  char line[3*PATH_MAX], type[32], options[PATH_MAX], *p;
+  int found = 0;
+  FILE* f;
+
+  if (!(f = fopen(mountinfo, "r")))
+    return 0;
+  while (!found && fgets(line, sizeof(line), f)) {
+    if (!(p = strstr(line, " - "))
+        || sscanf(p + 3, "%31s %*s %4095s", type, options) != 2)
+      continue;
+    if (version == 2 ? strcmp(type, "cgroup2")
+        : strcmp(type, "cgroup") || !has_token(options, "cpu"))
+      continue;
+    found = sscanf(line, "%*s %*s %*s %4095s %4095s", root, mount) == 2;
+  }
+  fclose(f);
+  return found;
+}
+
+/* Reads the CPU quota of a cgroup directory, in processors,
+   rounded up: cpu.max of cgroup v2 or cpu.cfs_quota_us and
+   cpu.cfs_period_us of cgroup v1; or 0 if it has none. */
+static int cgroup_dir_quota(const char* dir, int version) {
+  char file[PATH_MAX + 32], max[32];
+  long quota = -1, period = 0;
+  FILE* f;
+
+  if (version == 2) {
+    snprintf(file, sizeof(file), "%s/cpu.max", dir);
+    if ((f = fopen(file, "r"))) {
+      if (fscanf(f, "%31s %ld", max, &period) == 2 && strcmp(max, "max"))
+        sscanf(max, "%ld", &quota);
+      fclose(f);
+    }
+  } else {
+    snprintf(file, sizeof(file), "%s/cpu.cfs_quota_us", dir);
+    if ((f = fopen(file, "r"))) {
+      if (fscanf(f, "%ld", &quota) != 1)
+        quota = -1;
+      fclose(f);
+    }
+    snprintf(file, sizeof(file), "%s/cpu.cfs_period_us", dir);
+    if ((f = fopen(file, "r"))) {
+      if (fscanf(f, "%ld", &period) != 1)
+        period = 0;
+      fclose(f);
+    }
+  }
+  if (quota <= 0 || period <= 0)
+    return 0;
+  return (quota + period - 1) / period;
+}
+
+/* Reads the CPU quota of the cgroup of the process. The cgroup is
+   resolved under the mount of its hierarchy; the quota is the
+   tightest one of the cgroup and its ancestors in the mount. */
+int cpu_cgroup_quota(const char* cgroup, const char* mountinfo) {
+  char path[PATH_MAX], root[PATH_MAX], mount[PATH_MAX];
+  char dir[2*PATH_MAX], *relative = path, *p;
+  size_t n, m;
+  int version, q, quota = 0;
+
+  if (!(version = cgroup_find(cgroup, path, sizeof(path)))
+      || !cgroup_mount(mountinfo, version, root, mount))
+    return 0;
+  /* The mount may only show a subtree of the hierarchy. */
+  n = strlen(root);
+  if (strcmp(root, "/") && !strncmp(path, root, n)
+      && (!path[n] || path[n] == '/'))
+    relative = path + n;
+  snprintf(dir, sizeof(dir), "%s%s", mount, relative);
+  m = strlen(mount);
+  while ((n = strlen(dir)) > 1 && dir[n-1] == '/')
+    dir[n-1] = 0;
+  for (;;) {
+    if ((q = cgroup_dir_quota(dir, version)) && (!quota || q < quota))
+      quota = q;
+    if (strlen(dir) <= m || !(p = strrchr(dir, '/')))
+      break;
+    *p = 0;
+  }
+  return quota;
+}
+
+/* Returns the number of workers of a pool for a number of
+   seeds. */
+int cpu_pool_size(int seeds) {
+  int n = cpu_count();
+  return seeds > 0 && seeds < n ? seeds : n;
+}
+
+/* Fills an array with the processors of the affinity mask. */
+int cpu_list(int* cpus) {
+  cpu_set_t set;
+  int i, c = 0;
+
+  if (sched_getaffinity(0, sizeof(set), &set)) {
+    *cpus = 0;
+    return 1;
+  }
+  for (i = 0; i < CPU_SETSIZE; ++i)
+    if (CPU_ISSET(i, &set))
+      *(cpus + c++) = i;
+  return c;
+}
+
+/* Binds the calling thread to a processor. */
+int cpu_pin(int cpu) {
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return !pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/* Returns the NUMA node of a processor, from the node link of its
+   sysfs directory. */
+int cpu_node(int cpu) {
+  char path[64];
+  DIR* dir;
+  struct dirent* entry;
+  int node = 0;
+
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+  if (!(dir = opendir(path)))
+    return 0;
+  while ((entry = readdir(dir)))
+    if (!strncmp(entry->d_name, "node", 4)
+        && sscanf(entry->d_name + 4, "%d", &node) == 1)
+      break;
+  closedir(dir);
+  return node;
+}
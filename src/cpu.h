@@ -0,0 +1,80 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/**
+ * Returns the number of processors the process can use: the
+ * processors of its affinity mask, bounded by the CPU quota
+ * of its cgroup, if any.
+ * @return the number of processors, at least 1.
+ */
+int cpu_count();
+
+/**
+ * Returns the number of processors of the affinity mask of the
+ * process, without the cgroup quota.
+ * @return the number of processors, at least 1.
+ */
+int cpu_count_mask();
+
+/**
+ * Reads the CPU quota of the cgroup of the process, in
+ * processors, rounded up. The cgroup of the cpu controller is
+ * resolved from the cgroup file, a v1 hierarchy first and the v2
+ * one otherwise, under the mount of its hierarchy in the
+ * mountinfo file; the quota is the tightest one of the cgroup
+ * and its ancestors.
+ * @param cgroup the file in the format of /proc/self/cgroup.
+ * @param mountinfo the file in the format of /proc/self/mountinfo.
+ * @return the number of processors, or 0 if there is no quota.
+ */
+int cpu_cgroup_quota(const char* cgroup, const char* mountinfo);
+
+/**
+ * Returns the number of workers of the pool that runs a number
+ * of seeds: one per processor the process can use, but no more
+ * than the seeds.
+ * @param seeds the number of seeds.
+ * @return the number of workers, at least 1.
+ */
+int cpu_pool_size(int seeds);
+
+/**
+ * Fills an array with the processors of the affinity mask of
+ * the process, in increasing order.
+ * @param cpus the array; it must hold `cpu_count_mask()`
+ * processors.
+ * @return the number of processors written.
+ */
+int cpu_list(int* cpus);
+
+/**
+ * Binds the calling thread to a processor.
+ * @param cpu the processor.
+ * @return 1 if the thread was bound, 0 otherwise.
+ */
+int cpu_pin(int cpu);
+
+/**
+ * Returns the NUMA node of a processor.
+ * @param cpu the processor.
+ * @return the node, or 0 if it is unknown.
+ */
+int cpu_node(int cpu);
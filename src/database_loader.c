@@ -21,11 +21,43 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "database_loader.h"
 
 #define CITY_NUMBER 1092
 
+/* The snapshot file signature and version. */
+#define SNAPSHOT_MAGIC   "TSPSNAP"
+#define SNAPSHOT_VERSION 1
+/* The alignment of the snapshot sections. */
+#define SNAPSHOT_ALIGN   4096
+
+/* The snapshot header. */
+typedef struct {
+  /* The file signature. */
+  char magic[8];
+  /* The format version. */
+  uint32_t version;
+  /* The number of cities. */
+  uint32_t cities;
+  /* The size of a weight. */
+  uint32_t weight_size;
+  /* Padding. */
+  uint32_t reserved;
+  /* The offset of the coordinates section. */
+  uint64_t coordinates;
+  /* The offset of the connections section. */
+  uint64_t connections;
+  /* The size of the file. */
+  uint64_t size;
+} Snapshot_header;
+
 /* The database loader structure. */
 struct _Database_loader {
   /* The city array. */
@@ -36,84 +68,57 @@ struct _Database_loader {
   sqlite3 *db;
   /* The path where the database is located. */
   char *path;
-  /* The error message. */
-  char *zErrMsg;
-  /* The sql instructions. */
-  char *sql;
   /* The sql execution status. */
   int rc;
-  /* The index where the city is gonna be located in the array. */
-  int *n;
+  /* The number of references to the loader. */
+  atomic_int ref_count;
+  /* The mapped snapshot, if the loader was opened from one. */
+  void* map;
+  /* The size of the mapped snapshot. */
+  size_t map_size;
 };
 
-/* The callback data structure. */
-typedef struct _Data {
-  /* The database loader. */
-  Database_loader* loader;
-  /* The `fill` function. */
-  void (*f)(Database_loader*,
-            int*, char**);
-} Data;
-
 /* Creates a new Database Loader. */
 Database_loader* loader_new() {
   /* Heap allocation. */
   Database_loader* loader = malloc(sizeof(struct _Database_loader));
   loader->cities          = city_array(CITY_NUMBER+1);
   loader->connections     = calloc(1, (CITY_NUMBER+1)*sizeof(double[CITY_NUMBER+1]));
-  loader->n               = calloc(1, sizeof(int));
+  loader->path            = 0;
+  loader->db              = 0;
+  loader->map             = 0;
+  loader->map_size        = 0;
+  atomic_init(&loader->ref_count, 1);
   return loader;
 }
 
+/* Acquires a reference to the database loader. */
+Database_loader* loader_ref(Database_loader* loader) {
+  atomic_fetch_add(&loader->ref_count, 1);
+  return loader;
+}
+
+/* Releases a reference to the database loader. */
+void loader_unref(Database_loader* loader) {
+  if (atomic_fetch_sub(&loader->ref_count, 1) == 1)
+    loader_free(loader);
+}
+
 /* Frees the memory used by the database loader. */
 void loader_free(Database_loader* loader) {
   if (loader->cities)
     city_array_free(&(loader->cities), CITY_NUMBER+1);
-  if (loader->connections)
+  if (loader->map)
+    munmap(loader->map, loader->map_size);
+  else if (loader->connections)
     free(loader->connections);
   if (loader->path)
     free(loader->path);
-  if (loader->n)
-    free(loader->n);
-  if (loader->zErrMsg)
-    sqlite3_free(loader->zErrMsg);
   if (loader->db)
     sqlite3_close(loader->db);
   free(loader);
 }
 
-/* The callback function of the sql queries */
-static int callback(void *data, int numCol,
-                    char **colData, char **colName) {
-  int i;
-  Database_loader* loader = ((Data*)data)->loader;
-  void(*f)(Database_loader*, int*, char**) = ((Data*)data)->f;
-  i = 0;
-  while (i < numCol)
-    (*f)(loader, &i, colData);
-  return 0;
-}
-
-/* Fills up the database loader cities array. */
-static void fill_cities(Database_loader* loader,
-                        int* i, char** data) {
-  City* city = city_new(atoi(*(data+*i)), *(data+*i+1), *(data+*i+2),
-                        atof(*(data+*i+5)), atof(*(data+*i+4)));
-  city_array_set_element(&(loader->cities),&city, *loader->n + 1);
-  *i += 6;
-  ++*loader->n;
-}
-
-/* Fills up the database loader connections array. */
-static void fill_connections(Database_loader* loader,
-                             int* i, char** data) {
-  *(*(loader->connections + atoi(*(data+*i))) + atoi(*(data+*i+1)))
-    = atof(*(data+*i+2));
-  *(*(loader->connections + atoi(*(data+*i+1))) + atoi(*(data+*i)))
-    = atof(*(data+*i+2));
-  *i += 3;
-}
-
 /* Opens the database. */
 void loader_open(Database_loader* loader) {
   loader->path = realpath("./data/tsp.db", 0);
@@ -146,41 +151,103 @@ void loader_open_t(Database_loader* loader, char* path) {
   }
 }
 
-/* Loads the database cities into a two dimensional array. */
-static void loader_load_cities(Database_loader* loader) {
-  Data *data = malloc(sizeof(struct _Data));
-  data->loader = loader;
-  data->f = fill_cities;
-  loader->sql = "SELECT * FROM cities;";
-  loader->rc = sqlite3_exec(loader->db, loader->sql, callback,
-                            data, &(loader->zErrMsg));
+/* Prepares an sql statement. */
+static sqlite3_stmt* loader_prepare(Database_loader* loader,
+                                    const char* sql) {
+  sqlite3_stmt* stmt = 0;
+  loader->rc = sqlite3_prepare_v2(loader->db, sql, -1, &stmt, 0);
   if (loader->rc != SQLITE_OK) {
-    fprintf(stderr, "SQL error: %s\n", loader->zErrMsg);
-    sqlite3_free(loader->zErrMsg);
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(loader->db));
+    return 0;
   }
-  free(data);
+  return stmt;
 }
 
-/* Loads the database connections into a one dimensional array. */
-static void loader_load_connections(Database_loader* loader) {
-  Data *data = malloc(sizeof(struct _Data));
-  data->loader = loader;
-  data->f = fill_connections;
-  loader->sql = "SELECT * FROM connections;";
-  loader->rc = sqlite3_exec(loader->db, loader->sql, callback,
-                            data, &(loader->zErrMsg));
-  if (loader->rc != SQLITE_OK) {
-    fprintf(stderr, "SQL error: %s\n", loader->zErrMsg);
-    sqlite3_free(loader->zErrMsg);
+/* Returns the sql list of the ids, or an empty string. */
+static char* id_list(int n, int* ids) {
+  char* list = malloc(12*n+3);
+  int i;
+  *list = 0;
+  if (!n)
+    return list;
+  sprintf(list, "%s", "(");
+  for (i = 0; i < n; ++i)
+    sprintf(&list[strlen(list)], i+1 < n ? "%d," : "%d)", *(ids+i));
+  return list;
+}
+
+/* Loads the database cities into the cities array. */
+static void loader_load_cities(Database_loader* loader, char* list) {
+  char* sql = malloc(strlen(list)+128);
+  sqlite3_stmt* stmt;
+  City* city;
+  int id;
+
+  sprintf(sql, "SELECT id, latitude, longitude FROM cities%s%s;",
+          *list ? " WHERE id IN " : "", list);
+  stmt = loader_prepare(loader, sql);
+  free(sql);
+  if (!stmt)
+    return;
+
+  while ((loader->rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    id = sqlite3_column_int(stmt, 0);
+    if (id <= 0 || id > CITY_NUMBER)
+      continue;
+    if (*(loader->cities + id))
+      city_free(*(loader->cities + id));
+    city = city_new(id, 0, 0, sqlite3_column_double(stmt, 2),
+                    sqlite3_column_double(stmt, 1));
+    city_array_set_element(&(loader->cities), &city, id);
+  }
+  if (loader->rc != SQLITE_DONE)
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(loader->db));
+  sqlite3_finalize(stmt);
+}
+
+/* Loads the database connections into the adjacency matrix. */
+static void loader_load_connections(Database_loader* loader, char* list) {
+  char* sql = malloc(2*strlen(list)+128);
+  sqlite3_stmt* stmt;
+  double distance;
+  int i, j;
+
+  sprintf(sql, "SELECT id_city_1, id_city_2, distance FROM connections"
+          "%s%s%s%s;", *list ? " WHERE id_city_1 IN " : "", list,
+          *list ? " AND id_city_2 IN " : "", list);
+  stmt = loader_prepare(loader, sql);
+  free(sql);
+  if (!stmt)
+    return;
+
+  while ((loader->rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    i = sqlite3_column_int(stmt, 0);
+    j = sqlite3_column_int(stmt, 1);
+    if (i <= 0 || i > CITY_NUMBER || j <= 0 || j > CITY_NUMBER)
+      continue;
+    distance = sqlite3_column_double(stmt, 2);
+    *(*(loader->connections + i) + j) = distance;
+    *(*(loader->connections + j) + i) = distance;
   }
-  free(data);
+  if (loader->rc != SQLITE_DONE)
+    fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(loader->db));
+  sqlite3_finalize(stmt);
 }
 
 /* Loads the database. */
 void loader_load(Database_loader* loader) {
-  loader_load_cities(loader);
-  *loader->n -= *loader->n;
-  loader_load_connections(loader);
+  loader_load_ids(loader, 0, 0);
+}
+
+/* Loads the requested cities and the connections between them. */
+void loader_load_ids(Database_loader* loader, int n, int* ids) {
+  char* list;
+  if (!loader->db)
+    return;
+  list = id_list(n, ids);
+  loader_load_cities(loader, list);
+  loader_load_connections(loader, list);
+  free(list);
 }
 
 /* Returns the adjacency matrix of the loader. */
@@ -192,3 +259,125 @@ double (*loader_adj_matrix(Database_loader* loader))[CITY_NUMBER+1] {
 City** loader_cities(Database_loader* loader) {
   return loader->cities;
 }
+
+/* Returns the offset aligned to the snapshot alignment. */
+static uint64_t snapshot_align(uint64_t offset) {
+  return (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+/* Returns if a section of a snapshot of the given size lies
+   inside the file and is aligned for doubles. */
+static int snapshot_section(uint64_t offset, uint64_t size,
+                            uint64_t file_size) {
+  return !(offset % sizeof(double)) && offset <= file_size &&
+    size <= file_size - offset;
+}
+
+/* Writes zeros up to the requested offset. */
+static int snapshot_pad(FILE* file, uint64_t offset) {
+  long current = ftell(file);
+  while (current >= 0 && (uint64_t)current < offset) {
+    if (fputc(0, file) == EOF)
+      return 0;
+    ++current;
+  }
+  return current >= 0;
+}
+
+/* Writes the loaded database as a binary snapshot. */
+int loader_write_snapshot(Database_loader* loader, char* path) {
+  Snapshot_header header;
+  double coordinates[2];
+  size_t matrix = (CITY_NUMBER+1)*sizeof(double[CITY_NUMBER+1]);
+  int i, status = 1;
+  City* city;
+
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    perror("TSP_SA");
+    return 0;
+  }
+
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, SNAPSHOT_MAGIC);
+  header.version     = SNAPSHOT_VERSION;
+  header.cities      = CITY_NUMBER;
+  header.weight_size = sizeof(double);
+  header.coordinates = snapshot_align(sizeof(header));
+  header.connections = snapshot_align(header.coordinates +
+                                      (CITY_NUMBER+1)*sizeof(coordinates));
+  header.size        = header.connections + matrix;
+
+  status &= fwrite(&header, sizeof(header), 1, file) == 1;
+  status &= snapshot_pad(file, header.coordinates);
+  for (i = 0; status && i <= CITY_NUMBER; ++i) {
+    city = *(loader->cities + i);
+    coordinates[0] = city ? city_x_coordinate(city) : 0.0;
+    coordinates[1] = city ? city_y_coordinate(city) : 0.0;
+    status &= fwrite(coordinates, sizeof(coordinates), 1, file) == 1;
+  }
+  status &= snapshot_pad(file, header.connections);
+  status &= status && fwrite(loader->connections, matrix, 1, file) == 1;
+  status &= fclose(file) == 0;
+
+  if (!status)
+    fprintf(stderr, "Snapshot could not be written: %s\n", path);
+  return status;
+}
+
+/* Opens the database from a binary snapshot. */
+int loader_open_snapshot(Database_loader* loader, char* path) {
+  Snapshot_header* header;
+  struct stat st;
+  double* coordinates;
+  void* map;
+  City* city;
+  int i;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return 0;
+  if (fstat(fd, &st) || (size_t)st.st_size < sizeof(Snapshot_header)) {
+    close(fd);
+    return 0;
+  }
+  map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return 0;
+
+  header = (Snapshot_header*)map;
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) ||
+      header->version != SNAPSHOT_VERSION ||
+      header->cities != CITY_NUMBER ||
+      header->weight_size != sizeof(double) ||
+      header->size != (uint64_t)st.st_size ||
+      !snapshot_section(header->coordinates,
+                        (CITY_NUMBER+1)*2*sizeof(double), st.st_size) ||
+      !snapshot_section(header->connections,
+                        (CITY_NUMBER+1)*sizeof(double[CITY_NUMBER+1]),
+                        st.st_size)) {
+    fprintf(stderr, "Invalid snapshot: %s\n", path);
+    munmap(map, st.st_size);
+    return 0;
+  }
+
+  /* The weights are used directly from the mapping. */
+  if (loader->map)
+    munmap(loader->map, loader->map_size);
+  else if (loader->connections)
+    free(loader->connections);
+  loader->map         = map;
+  loader->map_size    = st.st_size;
+  loader->connections = (double (*)[CITY_NUMBER+1])
+    ((char*)map + header->connections);
+
+  coordinates = (double*)((char*)map + header->coordinates);
+  for (i = 1; i <= CITY_NUMBER; ++i) {
+    if (*(loader->cities + i))
+      city_free(*(loader->cities + i));
+    city = city_new(i, 0, 0, *(coordinates + 2*i), *(coordinates + 2*i+1));
+    city_array_set_element(&(loader->cities), &city, i);
+  }
+  return 1;
+}
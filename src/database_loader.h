@@ -21,6 +21,9 @@
 
 #include "heuristic.h"
 
+/* The default path of the binary snapshot. */
+#define SNAPSHOT_PATH "./data/tsp.bin"
+
 /**
  * Creates a new Database Loader.
  */
@@ -32,6 +35,21 @@ Database_loader* loader_new();
  */
 void loader_free(Database_loader* loader);
 
+/**
+ * Acquires a reference to the database loader. Once loaded,
+ * the loader is read-only and can be shared between threads.
+ * @param loader the database loader.
+ * @return the database loader.
+ */
+Database_loader* loader_ref(Database_loader* loader);
+
+/**
+ * Releases a reference to the database loader. The loader
+ * is freed when the last reference is released.
+ * @param loader the database loader.
+ */
+void loader_unref(Database_loader* loader);
+
 /**
  * Opens the database.
  * @param loader the database loader.
@@ -46,11 +64,41 @@ void loader_open(Database_loader*);
 void loader_open_t(Database_loader* loader, char* path);
 
 /**
- * Loads the database.
+ * Loads every city and connection of the database. The names
+ * of the cities are not loaded.
  * @param loader the database loader.
  */
 void loader_load(Database_loader* loader);
 
+/**
+ * Loads only the requested cities and the connections between
+ * them. The names of the cities are not loaded.
+ * @param loader the database loader.
+ * @param n the number of cities.
+ * @param ids the ids of the cities.
+ */
+void loader_load_ids(Database_loader* loader, int n, int* ids);
+
+/**
+ * Writes the loaded database as a binary snapshot: the
+ * coordinates of the cities and the adjacency matrix, aligned
+ * to be mapped and used directly.
+ * @param loader the database loader.
+ * @param path the snapshot path.
+ * @return 1, if the snapshot was written; 0, otherwise.
+ */
+int loader_write_snapshot(Database_loader* loader, char* path);
+
+/**
+ * Opens the database from a binary snapshot. The snapshot is
+ * mapped read-only, so it is shared with every process that
+ * maps it. The cities are loaded without names.
+ * @param loader the database loader.
+ * @param path the snapshot path.
+ * @return 1, if the snapshot was loaded; 0, otherwise.
+ */
+int loader_open_snapshot(Database_loader* loader, char* path);
+
 /**
  * Returns the adjacency matrix of the loader.
  * @return the adjacency matrix of the loader.
@@ -21,6 +21,40 @@
 
 #define CITY_NUMBER 1092
 
+/**
+ * The type of the weights of an instance. Single precision
+ * halves the memory of the weight matrix.
+ */
+#ifdef WEIGHT_FLOAT
+typedef float Weight;
+#else
+typedef double Weight;
+#endif
+
+/**
+ * The neighbourhoods explored by the heuristic.
+ */
+typedef enum {
+  /* The exchange of two cities. */
+  NEIGHBOURHOOD_SWAP,
+  /* The reversal of a segment of the path (2-opt). */
+  NEIGHBOURHOOD_TWO_OPT,
+  /* The relocation of a segment of 1 to 3 cities (Or-opt). */
+  NEIGHBOURHOOD_OR_OPT,
+  /* The exchange of two adjacent segments (3-opt). */
+  NEIGHBOURHOOD_THREE_OPT
+} Neighbourhood;
+
+/**
+ * The islands an island of the island model migrates from.
+ */
+typedef enum {
+  /* The predecessor of the island in a ring. */
+  TOPOLOGY_RING,
+  /* The island with the best solution. */
+  TOPOLOGY_BROADCAST
+} Topology;
+
 /**
  * The City opaque structure.
  */
@@ -31,6 +65,21 @@ typedef struct _City City;
  */
 typedef struct _Database_loader Database_loader;
 
+/**
+ * The Instance opaque structure.
+ */
+typedef struct _Instance Instance;
+
+/**
+ * The k-d tree opaque structure.
+ */
+typedef struct _Kd_tree Kd_tree;
+
+/**
+ * The Tour opaque structure.
+ */
+typedef struct _Tour Tour;
+
 /**
  * The TSP opaque structure.
  */
@@ -51,8 +100,32 @@ typedef struct _Path Path;
  */
 typedef struct _Batch Batch;
 
+/**
+ * The Tempering opaque structure.
+ */
+typedef struct _Tempering Tempering;
+
+/**
+ * The Board opaque structure.
+ */
+typedef struct _Board Board;
+
+/**
+ * The Race opaque structure.
+ */
+typedef struct _Race Race;
+
+#include "rng.h"
+#include "cpu.h"
+#include "wall_clock.h"
 #include "city.h"
 #include "database_loader.h"
+#include "kd_tree.h"
+#include "instance.h"
+#include "tour.h"
 #include "path.h"
 #include "tsp.h"
 #include "sa.h"
+#include "tempering.h"
+#include "board.h"
+#include "race.h"
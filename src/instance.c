@@ -0,0 +1,370 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "heuristic.h"
+#include "instance.h"
+
+#define CANDIDATES 10
+
+/* The instance structure. */
+struct _Instance {
+  /* The database loader. */
+  Database_loader* loader;
+  /* The number of cities. */
+  int n;
+  /* The ids of the cities. */
+  int* ids;
+  /* The cities, in local indices. */
+  City** cities;
+  /* The complete weight matrix, in local indices. */
+  Weight* weights;
+  /* The k-d tree over the coordinates of the cities. */
+  Kd_tree* tree;
+  /* The nearest cities of every city, in local indices. */
+  int* candidates;
+  /* The number of candidates of every city. */
+  int k;
+  /* The maximum distance. */
+  double max_distance;
+  /* The normalizer. */
+  double normalizer;
+  /* The number of references to the instance. */
+  atomic_int ref_count;
+};
+
+/* Determines the descending order of double numbers. */
+static int fdescending(const void*, const void*);
+
+/* Restores the min-heap property from the root. */
+static void sift_down(double*, int);
+
+/* Computes the maximum distance and the normalizer of the instance. */
+static void c_instance_statistics(Instance*);
+
+/* Returns the number of weights stored for n cities. */
+static int weights_size(int);
+
+/* Fills the cities array. */
+static void fill_cities(Instance*);
+
+/* Fills the complete weight matrix and the existing edges of the
+   candidate lists. */
+static void fill_weights(Instance*, int*);
+
+/* Inserts a city into a candidate row sorted by weight. */
+static int insert_candidate(Instance*, int, int*, int, int);
+
+/* Completes the candidate lists with the k-d tree. */
+static void fill_candidates(Instance*, int*);
+
+/* Creates a new Instance. */
+Instance* instance_new(Database_loader* loader, int n, int* ids) {
+  /* Heap allocation. */
+  Instance* instance = malloc(sizeof(struct _Instance));
+  instance->ids      = calloc(1, sizeof(int)*n);
+  instance->cities   = city_array(n);
+  instance->weights  = calloc(1, sizeof(Weight)*weights_size(n));
+  instance->k        = n-1 < CANDIDATES ? (n > 1 ? n-1 : 0) : CANDIDATES;
+  instance->candidates = calloc(1, sizeof(int)*(n*instance->k + 1));
+
+  /* Shared loader. */
+  instance->loader = loader_ref(loader);
+  instance->n      = n;
+  atomic_init(&instance->ref_count, 1);
+
+  /* Heap memory intialization. */
+  memcpy(instance->ids, ids, sizeof(int)*n);
+  fill_cities(instance);
+  instance->tree = kd_tree_new(instance->cities, n);
+
+  /* Instance statistics, weights and candidates. */
+  int* counts = calloc(n, sizeof(int));
+  c_instance_statistics(instance);
+  fill_weights(instance, counts);
+  fill_candidates(instance, counts);
+  free(counts);
+
+  return instance;
+}
+
+/* Creates a replica of an instance. */
+Instance* instance_replicate(Instance* instance) {
+  int n = instance->n, k = instance->k;
+  /* Heap allocation. */
+  Instance* replica = malloc(sizeof(struct _Instance));
+  replica->ids        = calloc(1, sizeof(int)*n);
+  replica->cities     = city_array(n);
+  replica->weights    = malloc(sizeof(Weight)*weights_size(n));
+  replica->candidates = malloc(sizeof(int)*(n*k + 1));
+
+  /* Shared loader. */
+  replica->loader = loader_ref(instance->loader);
+  replica->n      = n;
+  replica->k      = k;
+  replica->max_distance = instance->max_distance;
+  replica->normalizer   = instance->normalizer;
+  atomic_init(&replica->ref_count, 1);
+
+  /* Local copies. */
+  memcpy(replica->ids, instance->ids, sizeof(int)*n);
+  memcpy(replica->cities, instance->cities, sizeof(City*)*n);
+  memcpy(replica->weights, instance->weights,
+         sizeof(Weight)*weights_size(n));
+  memcpy(replica->candidates, instance->candidates,
+         sizeof(int)*(n*k + 1));
+  replica->tree = kd_tree_new(replica->cities, n);
+
+  return replica;
+}
+
+/* Frees the memory used by the instance. */
+static void instance_free(Instance* instance) {
+  if (instance->candidates)
+    free(instance->candidates);
+  if (instance->tree)
+    kd_tree_free(instance->tree);
+  if (instance->weights)
+    free(instance->weights);
+  if (instance->cities)
+    free(instance->cities);
+  if (instance->ids)
+    free(instance->ids);
+  if (instance->loader)
+    loader_unref(instance->loader);
+  free(instance);
+}
+
+/* Acquires a reference to the instance. */
+Instance* instance_ref(Instance* instance) {
+  atomic_fetch_add(&instance->ref_count, 1);
+  return instance;
+}
+
+/* Releases a reference to the instance. */
+void instance_unref(Instance* instance) {
+  if (atomic_fetch_sub(&instance->ref_count, 1) == 1)
+    instance_free(instance);
+}
+
+/* Returns the number of weights stored for n cities. */
+static int weights_size(int n) {
+#ifdef WEIGHT_PACKED
+  return n*(n+1)/2;
+#else
+  return n*n;
+#endif
+}
+
+/* Fills the cities array. */
+static void fill_cities(Instance* instance) {
+  City** cities = loader_cities(instance->loader);
+  int i;
+  for (i = 0; i < instance->n; ++i)
+    *(instance->cities + i) = *(cities + *(instance->ids + i));
+}
+
+/* Fills the complete weight matrix. Every existing edge is also
+   inserted in the candidate lists of its cities, whose numbers of
+   candidates are kept in counts, so the pairs are visited once. */
+static void fill_weights(Instance* instance, int* counts) {
+  double (*m)[CITY_NUMBER+1] = loader_adj_matrix(instance->loader);
+  Weight* w = instance->weights;
+  City** cities = instance->cities;
+  int* ids = instance->ids;
+  int i, j, n = instance->n, k = instance->k;
+  double weight;
+
+  for (i = 0; i < n; ++i)
+    for (j = i+1; j < n; ++j) {
+      weight = *(*(m + *(ids+i)) + *(ids+j));
+      if (weight == 0.0)
+        weight = city_distance(*(cities+i), *(cities+j))
+          * instance->max_distance;
+      *(w + instance_weight_index(n, i, j)) = weight;
+      *(w + instance_weight_index(n, j, i)) = weight;
+      if (k && *(*(m + *(ids+i)) + *(ids+j)) != 0.0) {
+        *(counts+i) = insert_candidate(instance, i, instance->candidates
+                                       + i*k, *(counts+i), j);
+        *(counts+j) = insert_candidate(instance, j, instance->candidates
+                                       + j*k, *(counts+j), i);
+      }
+    }
+}
+
+/* Inserts a city into a candidate row sorted by weight, with c
+   candidates, and returns the new number of candidates. */
+static int insert_candidate(Instance* instance, int i, int* row,
+                            int c, int j) {
+  int p, k = instance->k;
+  double w = instance_weight(instance, i, j);
+
+  if (c == k && w >= instance_weight(instance, i, *(row+k-1)))
+    return c;
+  /* The farthest candidate is dropped when the row is full. */
+  for (p = c < k ? c++ : k-1;
+       p && instance_weight(instance, i, *(row+p-1)) > w; --p)
+    *(row+p) = *(row+p-1);
+  *(row+p) = j;
+  return c;
+}
+
+/* Completes the candidate lists, which hold the existing edges.
+   Every existing edge is lighter than any missing one, whose
+   weight grows with the distance; so the lightest missing edges
+   are among the nearest cities of the k-d tree. */
+static void fill_candidates(Instance* instance, int* counts) {
+  double (*m)[CITY_NUMBER+1] = loader_adj_matrix(instance->loader);
+  int i, j, c, q, k = instance->k, n = instance->n;
+  int* ids = instance->ids;
+  int* near = malloc(sizeof(int)*(2*k+1));
+  double* distances = malloc(sizeof(double)*(2*k+1));
+
+  for (i = 0; k && i < n; ++i) {
+    c = *(counts+i);
+    q = kd_tree_nearest(instance->tree, i, 2*k, near, distances);
+    for (j = 0; j < q; ++j)
+      if (*(*(m + *(ids+i)) + *(ids + *(near+j))) == 0.0)
+        c = insert_candidate(instance, i, instance->candidates + i*k,
+                             c, *(near+j));
+  }
+  free(distances);
+  free(near);
+}
+
+/* Determines the descending order of double numbers. */
+static int fdescending(const void* n, const void* m) {
+  double a = *(double*)n, b = *(double*)m;
+  return (a < b) - (a > b);
+}
+
+/* Restores the min-heap property from the root. */
+static void sift_down(double* heap, int k) {
+  int i = 0, c;
+  double temp;
+  while ((c = 2*i+1) < k) {
+    if (c+1 < k && *(heap+c+1) < *(heap+c))
+      ++c;
+    if (*(heap+i) <= *(heap+c))
+      break;
+    temp = *(heap+i);
+    *(heap+i) = *(heap+c);
+    *(heap+c) = temp;
+    i = c;
+  }
+}
+
+/* Computes the maximum distance and the normalizer of the
+   instance: the sum of its n-1 heaviest edges, kept in a
+   min-heap while every pair is visited once. */
+static void c_instance_statistics(Instance* instance) {
+  double (*m)[CITY_NUMBER+1] = loader_adj_matrix(instance->loader);
+  int* ids = instance->ids;
+  int i, j, p, k = 0, n = instance->n;
+  int size = n > 1 ? n-1 : 0;
+  double* heap = calloc(1, sizeof(double)*(size+1));
+  double w, temp, max = 0.0, sum = 0.0;
+
+  for (i = 0; i < n; ++i)
+    for (j = i+1; j < n; ++j) {
+      w = *(*(m + *(ids+i)) + *(ids+j));
+      if (w == 0.0)
+        continue;
+      max = max < w ? w : max;
+      if (k < size) {
+        /* Sift up. */
+        for (p = k++, *(heap+p) = w;
+             p && *(heap+(p-1)/2) > *(heap+p); p = (p-1)/2) {
+          temp = *(heap+p);
+          *(heap+p) = *(heap+(p-1)/2);
+          *(heap+(p-1)/2) = temp;
+        }
+      } else if (size && w > *heap) {
+        *heap = w;
+        sift_down(heap, k);
+      }
+    }
+
+  /* Heaviest first, as the sum was always computed. */
+  qsort(heap, k, sizeof(double), fdescending);
+  for (i = 0; i < k; ++i)
+    sum += *(heap+i);
+  free(heap);
+
+  instance->max_distance = max;
+  instance->normalizer   = sum;
+}
+
+/* Returns the number of cities in the instance. */
+int instance_n(Instance* instance) {
+  return instance->n;
+}
+
+/* Returns the ids of the cities in the instance. */
+int* instance_ids(Instance* instance) {
+  return instance->ids;
+}
+
+/* Returns the array of cities of the instance. */
+City** instance_cities(Instance* instance) {
+  return instance->cities;
+}
+
+/* Returns the complete weight matrix of the instance. */
+Weight* instance_weights(Instance* instance) {
+  return instance->weights;
+}
+
+/* Returns the weight between two cities of the instance. */
+double instance_weight(Instance* instance, int i, int j) {
+  return *(instance->weights + instance_weight_index(instance->n, i, j));
+}
+
+/* Returns the k-d tree of the instance. */
+Kd_tree* instance_kd_tree(Instance* instance) {
+  return instance->tree;
+}
+
+/* Returns the candidate lists of the instance. */
+int* instance_candidates(Instance* instance) {
+  return instance->candidates;
+}
+
+/* Returns the number of candidates of every city. */
+int instance_candidate_number(Instance* instance) {
+  return instance->k;
+}
+
+/* Returns the maximum distance of the instance. */
+double instance_max_distance(Instance* instance) {
+  return instance->max_distance;
+}
+
+/* Returns the normalizer of the instance. */
+double instance_normalizer(Instance* instance) {
+  return instance->normalizer;
+}
+
+/* Returns the database loader of the instance. */
+Database_loader* instance_loader(Instance* instance) {
+  return instance->loader;
+}
@@ -0,0 +1,171 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/**
+ * Creates a new Instance. The cities are renumbered to the
+ * local indices 0..n-1, in the order of the ids, and the
+ * weight of every pair of them is computed once: the edge
+ * weight if the edge exists; the natural distance times the
+ * maximum distance, otherwise.
+ * @param loader the loaded database.
+ * @param n the number of cities.
+ * @param ids the ids of the cities.
+ */
+Instance* instance_new(Database_loader* loader, int n, int* ids);
+
+/**
+ * Creates a replica of an instance. The weight matrix and the
+ * candidate lists are copied by the calling thread, so on a
+ * NUMA host their memory is placed on the node of the thread
+ * that first touches it.
+ * @param instance the instance.
+ * @return the replica.
+ */
+Instance* instance_replicate(Instance* instance);
+
+/**
+ * Acquires a reference to the instance. The instance is
+ * read-only and can be shared between threads.
+ * @param instance the instance.
+ * @return the instance.
+ */
+Instance* instance_ref(Instance* instance);
+
+/**
+ * Releases a reference to the instance. The instance is
+ * freed when the last reference is released.
+ * @param instance the instance.
+ */
+void instance_unref(Instance* instance);
+
+/**
+ * Returns the number of cities in the instance.
+ * @param instance the instance.
+ * @return the number of cities.
+ */
+int instance_n(Instance* instance);
+
+/**
+ * Returns the ids of the cities in the instance, indexed by
+ * local index.
+ * @param instance the instance.
+ * @return the ids array.
+ */
+int* instance_ids(Instance* instance);
+
+/**
+ * Returns the array of cities of the instance, indexed by
+ * local index.
+ * @param instance the instance.
+ * @return the array of cities.
+ */
+City** instance_cities(Instance* instance);
+
+/**
+ * Returns the complete weight matrix of the instance,
+ * indexed by local index. The matrix is stored in
+ * row-major order, or as its packed upper triangle if
+ * WEIGHT_PACKED is defined; `instance_weight_index`
+ * computes the position of a weight in either layout.
+ * @param instance the instance.
+ * @return the weight matrix.
+ */
+Weight* instance_weights(Instance* instance);
+
+/**
+ * Returns the position of the weight between two cities
+ * in the weight matrix of an instance.
+ * @param n the number of cities of the instance.
+ * @param i the local index of the first city.
+ * @param j the local index of the second city.
+ * @return the position.
+ */
+static inline int instance_weight_index(int n, int i, int j) {
+#ifdef WEIGHT_PACKED
+  int t;
+  if (i > j)
+    t = i, i = j, j = t;
+  return i*n - i*(i-1)/2 + j - i;
+#else
+  return i*n + j;
+#endif
+}
+
+/**
+ * Returns the weight between two cities of the instance.
+ * @param instance the instance.
+ * @param i the local index of the first city.
+ * @param j the local index of the second city.
+ * @return the weight.
+ */
+double instance_weight(Instance* instance, int i, int j);
+
+/**
+ * Returns the k-d tree over the coordinates of the cities of
+ * the instance, indexed by local index.
+ * @param instance the instance.
+ * @return the k-d tree.
+ */
+Kd_tree* instance_kd_tree(Instance* instance);
+
+/**
+ * Returns the candidate lists of the instance: for every
+ * city, the local indices of its nearest cities by weight,
+ * nearest first, stored in consecutive rows of
+ * `instance_candidate_number` entries. The existing edges are
+ * collected while the weight matrix is filled, and the missing
+ * ones are taken from the k-d tree, so no pass over the pairs of
+ * cities is added to the O(n^2) one of the matrix.
+ * @param instance the instance.
+ * @return the candidate lists.
+ */
+int* instance_candidates(Instance* instance);
+
+/**
+ * Returns the number of candidates of every city of the
+ * instance.
+ * @param instance the instance.
+ * @return the number of candidates.
+ */
+int instance_candidate_number(Instance* instance);
+
+/**
+ * Returns the maximum distance of the instance.
+ * @param instance the instance.
+ * @return the maximum distance.
+ */
+double instance_max_distance(Instance* instance);
+
+/**
+ * Returns the normalizer of the instance.
+ * @param instance the instance.
+ * @return the normalizer.
+ */
+double instance_normalizer(Instance* instance);
+
+/**
+ * Returns the database loader of the instance.
+ * @param instance the instance.
+ * @return the database loader.
+ */
+Database_loader* instance_loader(Instance* instance);
@@ -0,0 +1,273 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "heuristic.h"
+#include "kd_tree.h"
+
+/* The k-d tree structure. The tree is implicit: every range of
+   the nodes array is rooted at its middle element, with the
+   lower and upper halves as subtrees. */
+struct _Kd_tree {
+  /* The number of cities. */
+  int n;
+  /* The points of the cities on the unit sphere. */
+  double* points;
+  /* The indexes of the cities, in tree order. */
+  int* nodes;
+  /* The splitting dimension of every node. */
+  char* dims;
+};
+
+/* Builds the subtree of a range of nodes. */
+static void build(Kd_tree*, int, int);
+
+/* Places the median of a range of nodes in its middle. */
+static void select_median(Kd_tree*, int, int, int);
+
+/* Returns the squared euclidean distance between two points. */
+static double distance_2(double*, double*);
+
+/* Searches the nearest cities in a subtree. */
+static void search_nearest(Kd_tree*, int, int, double*, int,
+                           int*, double*, int*, int);
+
+/* Searches the cities within a distance in a subtree. */
+static void search_radius(Kd_tree*, int, int, double*, int,
+                          double, int*, int*);
+
+/* Exchanges two cities of a heap. */
+static void swap(int*, double*, int, int);
+
+/* Restores the max-heap property from a node. */
+static void sift_down(int*, double*, int, int);
+
+/* Creates a new k-d tree. */
+Kd_tree* kd_tree_new(City** cities, int n) {
+  /* Heap allocation. */
+  Kd_tree* tree = malloc(sizeof(struct _Kd_tree));
+  tree->points  = malloc(sizeof(double)*3*(n+1));
+  tree->nodes   = malloc(sizeof(int)*(n+1));
+  tree->dims    = malloc(n+1);
+  tree->n       = n;
+
+  /* Heap memory intialization. */
+  int i;
+  double x, y;
+  for (i = 0; i < n; ++i) {
+    x = city_x_coordinate(*(cities+i))*M_PI/180;
+    y = city_y_coordinate(*(cities+i))*M_PI/180;
+    *(tree->points + 3*i)     = cos(y)*cos(x);
+    *(tree->points + 3*i + 1) = cos(y)*sin(x);
+    *(tree->points + 3*i + 2) = sin(y);
+    *(tree->nodes + i) = i;
+  }
+
+  build(tree, 0, n);
+  return tree;
+}
+
+/* Frees the memory used by the k-d tree. */
+void kd_tree_free(Kd_tree* tree) {
+  free(tree->points);
+  free(tree->nodes);
+  free(tree->dims);
+  free(tree);
+}
+
+/* Builds the subtree of a range of nodes, splitting it by the
+   dimension of largest spread. */
+static void build(Kd_tree* tree, int lo, int hi) {
+  int i, d, dim = 0, mid = (lo+hi)/2;
+  double min[3], max[3], c, spread = -1.;
+
+  if (hi - lo <= 1) {
+    if (hi > lo)
+      *(tree->dims+lo) = 0;
+    return;
+  }
+
+  for (d = 0; d < 3; ++d)
+    min[d] = HUGE_VAL, max[d] = -HUGE_VAL;
+  for (i = lo; i < hi; ++i)
+    for (d = 0; d < 3; ++d) {
+      c = *(tree->points + 3 * *(tree->nodes+i) + d);
+      min[d] = c < min[d] ? c : min[d];
+      max[d] = c > max[d] ? c : max[d];
+    }
+  for (d = 0; d < 3; ++d)
+    if (max[d] - min[d] > spread)
+      spread = max[d] - min[d], dim = d;
+
+  select_median(tree, lo, hi, dim);
+  *(tree->dims+mid) = dim;
+  build(tree, lo, mid);
+  build(tree, mid+1, hi);
+}
+
+/* Places the median of a range of nodes in its middle, with
+   the lower coordinates before it (quickselect). */
+static void select_median(Kd_tree* tree, int lo, int hi, int dim) {
+  int* nodes = tree->nodes;
+  int i, j, t, k = (lo+hi)/2;
+  double pivot;
+
+  --hi;
+  while (lo < hi) {
+    pivot = *(tree->points + 3 * *(nodes + (lo+hi)/2) + dim);
+    i = lo, j = hi;
+    while (i <= j) {
+      while (*(tree->points + 3 * *(nodes+i) + dim) < pivot)
+        ++i;
+      while (*(tree->points + 3 * *(nodes+j) + dim) > pivot)
+        --j;
+      if (i <= j) {
+        t = *(nodes+i), *(nodes+i) = *(nodes+j), *(nodes+j) = t;
+        ++i, --j;
+      }
+    }
+    if (k <= j)
+      hi = j;
+    else if (k >= i)
+      lo = i;
+    else
+      break;
+  }
+}
+
+/* Returns the squared euclidean distance between two points. */
+static double distance_2(double* p, double* q) {
+  double x = *p - *q, y = *(p+1) - *(q+1), z = *(p+2) - *(q+2);
+  return x*x + y*y + z*z;
+}
+
+/* Finds the nearest cities to a city of the tree. */
+int kd_tree_nearest(Kd_tree* tree, int i, int k, int* nearest,
+                    double* distances) {
+  int size = 0, c;
+
+  k = k < tree->n-1 ? k : tree->n-1;
+  if (k <= 0)
+    return 0;
+  search_nearest(tree, 0, tree->n, tree->points + 3*i, i,
+                 nearest, distances, &size, k);
+
+  /* The farthest city is popped first. */
+  for (c = size; c > 0; --c) {
+    swap(nearest, distances, 0, c-1);
+    sift_down(nearest, distances, 0, c-1);
+  }
+  return size;
+}
+
+/* Searches the nearest cities in a subtree, keeping the k
+   nearest found in a max-heap of indexes and squared
+   distances. */
+static void search_nearest(Kd_tree* tree, int lo, int hi, double* q,
+                           int self, int* heap, double* d_heap,
+                           int* size, int k) {
+  int p, mid = (lo+hi)/2, dim, c;
+  double d, diff;
+
+  if (lo >= hi)
+    return;
+  p   = *(tree->nodes+mid);
+  dim = *(tree->dims+mid);
+  d   = distance_2(q, tree->points + 3*p);
+
+  if (p != self) {
+    if (*size < k) {
+      /* Sift up. */
+      for (c = (*size)++, *(heap+c) = p, *(d_heap+c) = d;
+           c && *(d_heap+(c-1)/2) < *(d_heap+c); c = (c-1)/2)
+        swap(heap, d_heap, c, (c-1)/2);
+    } else if (d < *d_heap) {
+      *heap = p, *d_heap = d;
+      sift_down(heap, d_heap, 0, k);
+    }
+  }
+
+  /* The side of the query first. */
+  diff = *(q+dim) - *(tree->points + 3*p + dim);
+  if (diff < 0) {
+    search_nearest(tree, lo, mid, q, self, heap, d_heap, size, k);
+    if (*size < k || diff*diff < *d_heap)
+      search_nearest(tree, mid+1, hi, q, self, heap, d_heap, size, k);
+  } else {
+    search_nearest(tree, mid+1, hi, q, self, heap, d_heap, size, k);
+    if (*size < k || diff*diff < *d_heap)
+      search_nearest(tree, lo, mid, q, self, heap, d_heap, size, k);
+  }
+}
+
+/* Exchanges two cities of a heap. */
+static void swap(int* heap, double* d_heap, int i, int j) {
+  int t = *(heap+i);
+  double d = *(d_heap+i);
+  *(heap+i) = *(heap+j), *(heap+j) = t;
+  *(d_heap+i) = *(d_heap+j), *(d_heap+j) = d;
+}
+
+/* Restores the max-heap property from a node. */
+static void sift_down(int* heap, double* d_heap, int i, int k) {
+  int c;
+  while ((c = 2*i+1) < k) {
+    if (c+1 < k && *(d_heap+c+1) > *(d_heap+c))
+      ++c;
+    if (*(d_heap+i) >= *(d_heap+c))
+      break;
+    swap(heap, d_heap, i, c);
+    i = c;
+  }
+}
+
+/* Finds the cities within a distance of a city of the tree. */
+int kd_tree_radius(Kd_tree* tree, int i, double radius, int* cities) {
+  int size = 0;
+  double theta = radius/EARTH_RADIUS, r;
+
+  /* The chord of the arc of the distance. */
+  r = theta >= M_PI ? 2. : 2.*sin(theta/2.);
+  search_radius(tree, 0, tree->n, tree->points + 3*i, i,
+                r*r, cities, &size);
+  return size;
+}
+
+/* Searches the cities within a distance in a subtree. */
+static void search_radius(Kd_tree* tree, int lo, int hi, double* q,
+                          int self, double r_2, int* cities, int* size) {
+  int p, mid = (lo+hi)/2, dim;
+  double diff;
+
+  if (lo >= hi)
+    return;
+  p   = *(tree->nodes+mid);
+  dim = *(tree->dims+mid);
+
+  if (p != self && distance_2(q, tree->points + 3*p) <= r_2)
+    *(cities + (*size)++) = p;
+
+  diff = *(q+dim) - *(tree->points + 3*p + dim);
+  if (diff < 0 || diff*diff <= r_2)
+    search_radius(tree, lo, mid, q, self, r_2, cities, size);
+  if (diff >= 0 || diff*diff <= r_2)
+    search_radius(tree, mid+1, hi, q, self, r_2, cities, size);
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/**
+ * Creates a new k-d tree over the coordinates of an array of
+ * cities. The coordinates are mapped to the unit sphere, where
+ * the euclidean distance grows with the distance of
+ * `city_distance`, so the queries agree with it. The cities
+ * are not copied.
+ * @param cities the array of cities.
+ * @param n the number of cities.
+ */
+Kd_tree* kd_tree_new(City** cities, int n);
+
+/**
+ * Frees the memory used by the k-d tree.
+ * @param tree the k-d tree.
+ */
+void kd_tree_free(Kd_tree* tree);
+
+/**
+ * Finds the nearest cities to a city of the tree.
+ * @param tree the k-d tree.
+ * @param i the index of the city in the array of the tree.
+ * @param k the number of cities to find.
+ * @param nearest the array where the indexes of the cities
+ * are stored, nearest first; it must hold k indexes.
+ * @param distances the array where the squared distances of
+ * the cities on the unit sphere are stored, in the same order;
+ * it must hold k distances. Together with `nearest`, it is
+ * the scratch space of the query, so no memory is allocated.
+ * @return the number of cities found, which is less than k
+ * only if the tree has no more cities.
+ */
+int kd_tree_nearest(Kd_tree* tree, int i, int k, int* nearest,
+                    double* distances);
+
+/**
+ * Finds the cities within a distance of a city of the tree.
+ * @param tree the k-d tree.
+ * @param i the index of the city in the array of the tree.
+ * @param radius the distance, in the units of `city_distance`.
+ * @param cities the array where the indexes of the cities are
+ * stored, in no particular order; it must hold n-1 indexes.
+ * @return the number of cities found.
+ */
+int kd_tree_radius(Kd_tree* tree, int i, double radius, int* cities);
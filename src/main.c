@@ -21,20 +21,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <sys/sysinfo.h>
 #include <math.h>
 #include <time.h>
+#include <stdatomic.h>
 
 #include "heuristic.h"
 
 /* The Data structure. */
 typedef struct {
-  /* The number of cities. */
+  /* The shared instance. */
+  Instance* instance;
+  /* The first seed. */
+  unsigned int s;
+  /* The number of seeds. */
   int n;
-  /* The array of seeds. */
-  unsigned int seed;
-  /* The array of ids. */
-  int *ids;
+  /* The index of the next seed to run. */
+  atomic_int next;
   /* The maximum number of exeuctions
      of a batch. */
   int m;
@@ -52,13 +54,51 @@ typedef struct {
   int v;
   /* The temperature batch size. */
   int n_t;
+  /* The neighbourhood explored. */
+  Neighbourhood nb;
+  /* The first-improvement sweep option. */
+  int g;
+  /* The maximum number of moves of the sweep. */
+  long i;
+  /* The maximum time of the sweep. */
+  double u;
+  /* The number of threads of the sweep. */
+  int j;
+  /* The two-level tour option of the sweep. */
+  int r;
+  /* The pinning option of the workers. */
+  int b;
+  /* The processors of the workers. */
+  int* cpus;
+  /* The number of processors of the workers. */
+  int c;
+  /* The replicas of the instance, by NUMA node. */
+  Instance** replicas;
+  /* The number of NUMA nodes. */
+  int nodes;
+  /* The lock of the replicas. */
+  pthread_mutex_t lock;
+  /* The number of started workers. */
+  atomic_int workers;
+  /* The board of the island model, or 0. */
+  Board* board;
+  /* The number of batches between migrations. */
+  int y;
+  /* The topology of the migrations. */
+  Topology z;
+  /* The race between the seeds, or 0. */
+  Race* race;
+  /* The time the run must end, or 0. */
+  double end;
+  /* The number of workers. */
+  int pool;
 } Data;
 
 /**
  * Creates a new Data.
- * @param n the number of cities.
- * @param ids the ids.
- * @param seed the seed.
+ * @param instance the shared instance.
+ * @param s the first seed.
+ * @param n the number of seeds.
  * @param m The maximum number of executions
  * of a batch.
  * @param l The batch size.
@@ -66,17 +106,37 @@ typedef struct {
  * @param e The epsilon.
  * @param phi The phi.
  * @param a The temperature batch size.
+ * @param nb The neighbourhood explored.
+ * @param g The first-improvement sweep option.
+ * @param i The maximum number of moves of the sweep.
+ * @param u The maximum time of the sweep.
+ * @param j The number of threads of the sweep.
+ * @param r The two-level tour option of the sweep.
+ * @param b The pinning option of the workers.
+ * @param y The number of batches between migrations, or 0.
+ * @param z The topology of the migrations.
+ * @param q The quantile of the race, or 0.
+ * @param d The number of cooling steps between the checks of
+ * the race.
+ * @param end The time the run must end, or 0.
  */
-static Data* data_new(int n, int* ids, unsigned int seed,
+static Data* data_new(Instance* instance, unsigned int s, int n,
                       int m, int l, long double t, double e,
-                      double phi, double a, int v, int n_t) {
+                      double phi, double a, int v, int n_t,
+                      Neighbourhood nb, int g, long i, double u,
+                      int j, int r, int b, int y, Topology z,
+                      double q, int d, double end) {
+  int k, node;
   /* Heap allocation. */
   Data* data = malloc(sizeof(Data));
-  data->ids  = calloc(1, sizeof(int)*n);
+  data->cpus = malloc(sizeof(int)*cpu_count_mask());
+
+  /* Shared instance. */
+  data->instance = instance_ref(instance);
 
   /* Value copy. */
+  data->s    = s;
   data->n    = n;
-  data->seed = seed;
   data->t    = t;
   data->m    = m;
   data->l    = l;
@@ -85,9 +145,30 @@ static Data* data_new(int n, int* ids, unsigned int seed,
   data->a    = a;
   data->v    = v;
   data->n_t  = n_t;
+  data->nb   = nb;
+  data->g    = g;
+  data->i    = i;
+  data->u    = u;
+  data->j    = j;
+  data->r    = r;
+  data->b    = b;
+  data->y    = y;
+  data->z    = z;
+  data->board = 0;
+  data->race  = q ? race_new(n, q, d) : 0;
+  data->end   = end;
+  data->pool  = 1;
+  atomic_init(&data->next, 0);
+  atomic_init(&data->workers, 0);
 
-  /* Heap initialization. */
-  memcpy(data->ids, ids, sizeof(int)*n);
+  /* Processors and NUMA nodes. */
+  data->c = cpu_list(data->cpus);
+  data->nodes = 1;
+  for (k = 0; b && k < data->c; ++k)
+    if ((node = cpu_node(*(data->cpus + k))) >= data->nodes)
+      data->nodes = node + 1;
+  data->replicas = calloc(data->nodes, sizeof(Instance*));
+  pthread_mutex_init(&data->lock, NULL);
   return data;
 }
 
@@ -96,28 +177,138 @@ static Data* data_new(int n, int* ids, unsigned int seed,
  * @param data the data.
  */
 static void data_free(Data* data) {
-  if (data->ids)
-    free(data->ids);
+  int k;
+  for (k = 0; k < data->nodes; ++k)
+    if (*(data->replicas + k))
+      instance_unref(*(data->replicas + k));
+  if (data->instance)
+    instance_unref(data->instance);
+  if (data->board)
+    board_free(data->board);
+  if (data->race)
+    race_free(data->race);
+  pthread_mutex_destroy(&data->lock);
+  free(data->replicas);
+  free(data->cpus);
   free(data);
 }
 
 /**
  * Executes the heuristic with the tsp instance.
- * @param data the user data.
+ * @param data the shared data.
+ * @param instance the instance.
+ * @param k the index of the seed.
+ * @param island the island of the worker.
  */
-static void* heuristic(void* v_data) {
-  Data* data = (Data*)v_data;
-  TSP* tsp = tsp_new(data->n, data->ids, data->seed);
+static void heuristic(Data* data, Instance* instance, int k,
+                      int island) {
+  TSP* tsp = tsp_new(instance, data->s + k);
   SA* sa = sa_new(tsp, data->t, data->m, data->l,
                   data->e, data->phi, data->a,
-                  data->n_t, data->v);
+                  data->n_t, data->v, data->nb);
+  sa_set_sweep(sa, data->g, data->i, data->u, data->j);
+  sa_set_sweep_tour(sa, data->r);
+  if (data->board)
+    sa_set_board(sa, data->board, island, data->y);
+  sa_set_race(sa, data->race);
+  if (data->end)
+    sa_set_time_limit(sa, wall_clock_share(data->end, data->n - k,
+                                           data->pool));
   threshold_accepting(sa);
+  if (data->board)
+    board_retire(data->board, island);
   sa_free(sa);
   tsp_free(tsp);
-  data_free(v_data);
+}
+
+/**
+ * Binds the calling worker to a processor and returns the
+ * instance it should read. On a host with several NUMA nodes,
+ * the first worker of every node creates the replica of the
+ * node, so the weight matrix is read from local memory.
+ * @param data the shared data.
+ * @param cpu the processor.
+ * @return the instance.
+ */
+static Instance* pin_worker(Data* data, int cpu) {
+  Instance* instance;
+  int node;
+
+  if (!cpu_pin(cpu))
+    return data->instance;
+  if (data->nodes == 1)
+    return data->instance;
+  node = cpu_node(cpu);
+  pthread_mutex_lock(&data->lock);
+  if (!*(data->replicas + node))
+    *(data->replicas + node) = instance_replicate(data->instance);
+  instance = *(data->replicas + node);
+  pthread_mutex_unlock(&data->lock);
+  return instance;
+}
+
+/**
+ * Executes the seeds of the shared queue until it is empty.
+ * Each result is printed as soon as its seed finishes.
+ * @param data the shared data.
+ */
+static void* worker(void* v_data) {
+  Data* data = (Data*)v_data;
+  Instance* instance = data->instance;
+  int w = atomic_fetch_add(&data->workers, 1);
+  int k;
+
+  if (data->b)
+    instance = pin_worker(data, *(data->cpus + w % data->c));
+  while ((k = atomic_fetch_add(&data->next, 1)) < data->n)
+    heuristic(data, instance, k, w);
   return 0;
 }
 
+/**
+ * Executes the seeds of the data with parallel tempering, x
+ * consecutive seeds, one per replica, at a time. The last group
+ * only has the seeds left; a single seed is annealed alone.
+ * @param data the shared data.
+ * @param x the number of replicas.
+ * @param w the number of batches of every replica.
+ */
+static void run_tempering(Data* data, int x, int w) {
+  int k, r;
+
+  for (k = 0; k < data->n; k += x) {
+    r = data->n - k < x ? data->n - k : x;
+    if (r == 1) {
+      heuristic(data, data->instance, k, 0);
+      break;
+    }
+    Tempering* tempering = tempering_new(data->instance, data->s + k,
+                                         r, w, data->t, data->m,
+                                         data->l, data->e, data->phi,
+                                         data->a, data->n_t, data->v,
+                                         data->nb);
+    SA* sa;
+    double u = data->u, rest;
+    if (data->end)
+      tempering_set_time_limit(tempering,
+                               wall_clock_share(data->end,
+                                                (data->n - k + x-1)/x, 1));
+    sa = tempering_run(tempering);
+    if (data->v)
+      printf("Exchanges[%u]: %ld\n", data->s + k,
+             tempering_exchanges(tempering));
+    /* The sweep takes the rest of the share of the run. */
+    if (data->end) {
+      rest = wall_clock_share(data->end, (data->n - k + x-1)/x, 1);
+      u = u && u < rest ? u : rest;
+    }
+    sa_set_sweep(sa, data->g, data->i, u, data->j);
+    sa_set_sweep_tour(sa, data->r);
+    sa_finish(sa);
+    tempering_free(tempering);
+  }
+}
+
 /* Prints the execution instructions of the program. */
 static void usage() {
   fprintf(stderr, "Usage:\n\t./TSP_SA [tsp-parameters]"
@@ -137,7 +328,10 @@ static void usage() {
           "\t-a\n"
           "\t\tSets the desired average of accepted cities.\n\n"
           "\t-k\n"
-          "\t\tSets the desired temperature batch size.\n\n");
+          "\t\tSets the desired temperature batch size.\n\n"
+          "\t-o\n"
+          "\t\tSets the neighbourhood: swap (default), 2opt, oropt"
+          " or 3opt.\n\n");
   fprintf(stderr, "Options:\n"
           "\t-s\n"
           "\t\tSets the initial seed the program will use.\n\n"
@@ -145,6 +339,41 @@ static void usage() {
           "\t\tSets the number of seeds the program will use.\n\n"
           "\t-v\n"
           "\t\tPrints the evaluation for each path the program finds.\n\n"
+          "\t-g\n"
+          "\t\tApplies the first improving move of each city in the"
+          " final sweep, instead of the best one.\n\n"
+          "\t-i\n"
+          "\t\tSets the maximum number of moves of the final sweep.\n\n"
+          "\t-u\n"
+          "\t\tSets the maximum time of the final sweep, in seconds.\n\n"
+          "\t-j\n"
+          "\t\tSets the number of threads of the final sweep.\n\n"
+          "\t-r\n"
+          "\t\tUses a two-level list tour in the final sweep, for"
+          " large instances.\n\n"
+          "\t-y\n"
+          "\t\tRuns the seeds as islands that migrate their best"
+          " solutions every given number of batches.\n\n"
+          "\t-z\n"
+          "\t\tSets the topology of the islands: ring (default) or"
+          " broadcast.\n\n"
+          "\t-q\n"
+          "\t\tCuts the seeds whose best cost is worse than the given"
+          " quantile of the best costs of their peers.\n\n"
+          "\t-d\n"
+          "\t\tSets the number of cooling steps between the checkpoints"
+          " of the race.\n\n"
+          "\t-x\n"
+          "\t\tRuns parallel tempering with the given number of"
+          " replicas, one per seed.\n\n"
+          "\t-w\n"
+          "\t\tSets the number of batches of every replica of the"
+          " parallel tempering.\n\n"
+          "\t-b\n"
+          "\t\tBinds every worker to a processor, with a copy of the"
+          " instance on every NUMA node.\n\n"
+          "\t--time-limit\n"
+          "\t\tSets the time limit of the run, in seconds.\n\n"
           "\t-c\n"
           "\t\tSets the ids of the desired instance. It can be a file or"
           " a list of ids.\n\n"
@@ -154,34 +383,24 @@ static void usage() {
 }
 
 /**
- * Creates the requested number of threads
- * to execute the heuristic.
+ * Creates the pool of threads that executes every seed
+ * of the data; the pool is joined once, after the last seed.
+ * @param data the shared data.
  * @param n the number of threads.
- * @param s the initial seed.
- * @param inst the TSP instance.
- * @param c the number of cities.
- * @param m The maximum number of exeuctions of a batch.
- * @param l The batch size.
- * @param t The temperature.
- * @param e The epsilon.
- * @param phi The phi.
- * @param a The average.
- * @param v The verbose option.
- * @param n_t the the temperature batch size.
  */
-static void create_threads(int n, int s, int* inst, int c,
-                           int m, int l, long double t, double e,
-                           double phi, double a, int v, int n_t) {
+static void create_threads(Data* data, int n) {
   int i;
   pthread_t th[n];
 
-  for (i = 0; i < n; ++i) {
-    Data* data = data_new(c, inst, i+s, m, l, t, e, phi, a, v, n_t);
-    if (pthread_create(th+i, NULL, heuristic, data)) {
+  data->pool = n;
+  /* One island per worker. */
+  if (data->y)
+    data->board = board_new(data->instance, n, data->z);
+  for (i = 0; i < n; ++i)
+    if (pthread_create(th+i, NULL, worker, data)) {
       fprintf(stderr, "Thread could not be created.");
       exit(1);
     }
-  }
 
   for (i = 0; i < n; ++i) {
     if(pthread_join(*(th+i), NULL)) {
@@ -191,6 +410,39 @@ static void create_threads(int n, int s, int* inst, int c,
   }
 }
 
+/* Parses the name of a topology. */
+static Topology parse_topology(const char* name) {
+  if (!strcmp(name, "ring"))
+    return TOPOLOGY_RING;
+  if (!strcmp(name, "broadcast"))
+    return TOPOLOGY_BROADCAST;
+  fprintf(stderr, "TSP_SA: Invalid topology %s\n", name);
+  exit(1);
+}
+
+/* Parses the quantile of a race, in (0, 1]. */
+static double parse_quantile(const char* value) {
+  double q = atof(value);
+  if (q > 0 && q <= 1)
+    return q;
+  fprintf(stderr, "TSP_SA: Invalid quantile %s\n", value);
+  exit(1);
+}
+
+/* Parses the name of a neighbourhood. */
+static Neighbourhood parse_neighbourhood(const char* name) {
+  if (!strcmp(name, "swap"))
+    return NEIGHBOURHOOD_SWAP;
+  if (!strcmp(name, "2opt"))
+    return NEIGHBOURHOOD_TWO_OPT;
+  if (!strcmp(name, "oropt"))
+    return NEIGHBOURHOOD_OR_OPT;
+  if (!strcmp(name, "3opt"))
+    return NEIGHBOURHOOD_THREE_OPT;
+  fprintf(stderr, "TSP_SA: Invalid neighbourhood %s\n", name);
+  exit(1);
+}
+
 /* Parses the file that contains the cities. */
 static int* parse_file(const char* file_name, int* size) {
   int* ids, id, i = 0;
@@ -306,14 +558,26 @@ static int* parse_cities(int argc, char **argv, int *size, int* status) {
 
 /* Parses the arguments passed to the program. */
 void parse_arguments(int argc, char** argv) {
+  /* The time limit includes the loading of the instance. */
+  double start = wall_clock_seconds();
   if (argc < 3)
     usage();
   int c, m = 0, l = 0, size = 0, s = 0, v = 0,
     * ids = 0, cities = 0, n = 1, n_t = 0;
   long double t = 0.;
   double e = 0., phi = 0., a = 0.;
+  Neighbourhood nb = NEIGHBOURHOOD_SWAP;
+  int g = 0;
+  long it = 0;
+  double u = 0.;
+  int j = 1, r = 0, b = 0, x = 0, w = 0, y = 0;
+  Topology z = TOPOLOGY_RING;
+  double q = 0., limit = 0.;
+  int d = 0;
   while (--argc > 0)
-    if ((*++argv)[0] == '-')
+    if (!strcmp(*++argv, "--time-limit"))
+      limit = argc - 1 ? atof(*(argv + 1)) : limit;
+    else if ((*argv)[0] == '-')
       while ((c = *++argv[0]))
         switch (c) {
         case 't':
@@ -343,12 +607,51 @@ void parse_arguments(int argc, char** argv) {
         case 'v':
           v = 1;
           break;
+        case 'g':
+          g = 1;
+          break;
+        case 'r':
+          r = 1;
+          break;
+        case 'b':
+          b = 1;
+          break;
+        case 'y':
+          y = argc - 1 ? atoi(*(argv + 1)) : y;
+          break;
+        case 'z':
+          z = argc - 1 ? parse_topology(*(argv + 1)) : z;
+          break;
+        case 'q':
+          q = argc - 1 ? parse_quantile(*(argv + 1)) : q;
+          break;
+        case 'd':
+          d = argc - 1 ? atoi(*(argv + 1)) : d;
+          break;
+        case 'x':
+          x = argc - 1 ? atoi(*(argv + 1)) : x;
+          break;
+        case 'w':
+          w = argc - 1 ? atoi(*(argv + 1)) : w;
+          break;
+        case 'i':
+          it = argc - 1 ? atol(*(argv + 1)) : it;
+          break;
+        case 'u':
+          u = argc - 1 ? atof(*(argv + 1)) : u;
+          break;
+        case 'j':
+          j = argc - 1 ? atoi(*(argv + 1)) : j;
+          break;
         case 'c':
           ids = parse_cities(argc, argv, &size, &cities);
           break;
         case 'k':
           n_t = argc - 1 ? atoi(*(argv + 1)) : n_t;
           break;
+        case 'o':
+          nb = argc - 1 ? parse_neighbourhood(*(argv + 1)) : nb;
+          break;
         case 'f':
           parse_parameters(*(argv+1), &t, &l, &m, &e, &phi, &a, &s, &n_t);
           break;
@@ -359,10 +662,12 @@ void parse_arguments(int argc, char** argv) {
         }
   if (!cities)
     usage();
+  if (x > 1 && (y || q || b)) {
+    fprintf(stderr, "TSP_SA: -y, -q and -b cannot be used with -x\n");
+    exit(1);
+  }
 
-  int procs = get_nprocs();
-  int lower = n < procs ? n : procs;
-  int x = ceil((double)n/lower);
+  int lower = cpu_pool_size(n);
 
   for(int i =0 ; i <size; ++i)
     if ((*(ids+i) <= 0) || (*(ids+i) > 1092)) {
@@ -370,8 +675,27 @@ void parse_arguments(int argc, char** argv) {
       exit(1);
     }
 
-  while (x--)
-    create_threads(lower, s, ids, size, m, l, t, e, phi, a, v, n_t);
+  /* The instance is prepared once and shared by every thread. */
+  Database_loader* loader = loader_new();
+  if (!loader_open_snapshot(loader, SNAPSHOT_PATH)) {
+    loader_open(loader);
+    loader_load_ids(loader, size, ids);
+  }
+  Instance* instance = instance_new(loader, size, ids);
+  loader_unref(loader);
+
+  Data* data = data_new(instance, s, n, m, l, t, e, phi, a, v, n_t,
+                        nb, g, it, u, j, r, b, y, z, q, d,
+                        limit ? start + limit : 0.);
+  if (x > 1)
+    run_tempering(data, x, w);
+  else
+    create_threads(data, lower);
+  if (data->race)
+    printf("\nIncumbent[%u]:%.16f\n", race_incumbent_seed(data->race),
+           race_incumbent(data->race));
+  data_free(data);
+  instance_unref(instance);
   if (ids)
     free(ids);
 }
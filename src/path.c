@@ -24,144 +24,143 @@
 #include "heuristic.h"
 #include "path.h"
 
-/* The path structure. */
+#define PAIRS 64
+
+/* The path structure. The instance context is shared and
+   read-only; only the tour is copied. */
 struct _Path {
-  /* The arrays of cities. */
-  City** cities, **r_path;
+  /* The instance. */
+  Instance* instance;
+  /* The complete weight matrix. */
+  Weight* matrix;
+  /* The normalizer. */
+  double normalizer;
   /* The number of cities. */
   int n;
-  /* The ids of the city. */
+  /* The local indexes of the cities, in tour order, allocated
+     with the path. */
   int* ids;
-  /* The distances between every city in
-     the path. */
-  double* distances;
   /* The sum of the costs of the cities. */
   long double cost_sum;
-  /* The maximum distance. */
-  double max_distance;
-  /* The normalizer. */
-  double normalized_v;
-  /* The adjacency matrix. */
-  double (*matrix)[CITY_NUMBER+1];
   /* The indexes with which a swap has been made*/
   int i,j;
-  /* The string representation. */
+  /* The random number generator. */
+  Rng rng;
+  /* The random pairs of indexes, generated in bulk. */
+  int pair_i[PAIRS], pair_j[PAIRS];
+  /* The next random pair. */
+  int pair;
+  /* The string representation, allocated when requested. */
   char* str;
-  /* The seed. */
-  unsigned int seed;
+  /* The two-level tour, if enabled; the ids are then updated
+     only when requested. */
+  Tour* tour;
 };
 
-/* Fills the path array. */
-static void fill_path_array(Path*);
-
-/* Computes the maximum distance of the path. */
-static double c_path_max_distance(Path*);
-
-/* Tells if the edge in the graph exists. */
-static int edge_exists(Path*, City*, City*);
-
-/* Determines the order of double numbers. */
-static int fequal(const void*, const void*);
-
-/* Computes the normalized path weights. */
-static double c_path_normalize(Path*);
-
 /* Computes the random indexes used by swap function. */
 static void random_indexes(Path*);
 
 /* Computes the path swapping. */
 static void c_path_swap(Path*);
 
-/* Copies the ids of one path to another. */
-static void copy_ids(Path*, int*);
+/* Allocates a path and its tour in one block. */
+static Path* path_alloc(int);
+
+/* Fills the path with the identity permutation. */
+static void fill_identity(Path*);
+
+/* Reverses the segment between two indexes of the tour. */
+static void reverse(int*, int, int);
+
+/* Copies the two-level tour, if enabled, into the ids. */
+static void sync(Path*);
+
+/* Returns the city at a position of the path. */
+static inline int at(Path* path, int p) {
+  return path->tour ? tour_city(path->tour, p) : *(path->ids+p);
+}
 
 /* Creates a new Path. */
-Path* path_new(City** cities, int n, int* ids,
-               unsigned int seed, double (*matrix)[CITY_NUMBER+1]) {
+Path* path_new(Instance* instance, unsigned int seed) {
   /* Heap allocated. */
-  Path* path      = malloc(sizeof(struct _Path));
-  path->distances = calloc(1,sizeof(double)*n*(n-1)/2);
-  path->str       = malloc(sizeof(int)*n*2+2);
-  path->r_path    = city_array(n);
-  path->ids       = calloc(1, sizeof(int)*n);
+  Path* path = path_alloc(instance_n(instance));
 
   /* Pointer copy. */
-  path->cities = cities;
-  path->n      = n;
-  path->matrix = matrix;
-  path->seed   = seed;
-
+  path->instance   = instance;
+  path->matrix     = instance_weights(instance);
+  path->normalizer = instance_normalizer(instance);
+  path->pair       = PAIRS;
+  rng_seed(&path->rng, seed);
 
   /* Heap memory intialization. */
-  copy_ids(path, ids);
-  fill_path_array(path);
+  fill_identity(path);
 
   /* Linear operations. */
-  path->max_distance = c_path_max_distance(path);
-  path->cost_sum     = path_cost_sum(path);
-  path->normalized_v = c_path_normalize(path);
+  path->cost_sum = path_cost_sum(path);
+
+  return path;
+}
 
+/* Allocates a path and its tour in one block. */
+static Path* path_alloc(int n) {
+  Path* path = malloc(sizeof(struct _Path) + sizeof(int)*n);
+  path->ids  = (int*)(path + 1);
+  path->n    = n;
+  path->str  = 0;
+  path->tour = 0;
   return path;
 }
 
 /* Frees the memory used by the path. */
 void path_free(Path* path) {
-  if (path->r_path)
-    free(path->r_path);
-  if (path->distances)
-    free(path->distances);
   if (path->str)
     free(path->str);
-  if (path->ids)
-    free(path->ids);
+  if (path->tour)
+    tour_free(path->tour);
   free(path);
 }
 
 /* Computes the weight of an edge between two cities. */
-double path_weight_function(Path* path, City* c_1, City* c_2) {
-  return edge_exists(path, c_1, c_2) ?
-    *(*(path->matrix + city_id(c_1))+city_id(c_2))
-    : city_distance(c_1, c_2) * path_max_distance(path);
+double path_weight_function(Path* path, int c_1, int c_2) {
+  return *(path->matrix + instance_weight_index(path->n, c_1, c_2));
 }
 
 /* Computes the sum of the costs. */
 double path_cost_sum(Path* path) {
-  int* ids = path->ids;
-  City** cities = path->cities;
+  int* ids = path_ids(path);
   int i;
   double cost = 0.0;
   int n = path->n;
   for (i = 0; i+1 < n; ++i)
-    cost += path_weight_function(path, *(cities + *(ids+i)),
-                                 *(cities + *(ids+i+1)));
+    cost += path_weight_function(path, *(ids+i), *(ids+i+1));
   return cost;
 }
 
 /* Normalizes the path weights. */
 double path_normalize(Path* path) {
-  return path->normalized_v;
+  return path->normalizer;
 }
 
 /* Computes the cost function. */
 long double path_cost_function(Path* path) {
-  return path->cost_sum/path->normalized_v;
+  return path->cost_sum/path->normalizer;
 }
 
 /* Randomizes the initial path. */
 void path_randomize(Path* path) {
   int i, temp, r, n = path->n;
-  int *ids_r = path->ids;
-  City** cities = path->cities;
+  int *ids_r = path_ids(path);
 
-  for (i = 0; i < n; ++i) {
-    r = rand_r(&path->seed) % n;
+  /* Fisher-Yates shuffle. */
+  for (i = n-1; i > 0; --i) {
+    r = rng_bounded(&path->rng, i+1);
     temp = *(ids_r + r);
     *(ids_r + r) = *(ids_r + i);
     *(ids_r + i) = temp;
   }
-  for (i = 0; i < n; ++i)
-    *(path->r_path+i) = *(cities + *(ids_r + i));
 
+  if (path->tour)
+    tour_set(path->tour, ids_r);
   path->cost_sum = path_cost_sum(path);
 }
 
@@ -185,73 +184,184 @@ void path_swap_indexes(Path* path, int i, int j) {
 
 /* Computes the path swapping. */
 static void c_path_swap(Path* path) {
-  City** r_path = path->r_path, *temp;
-  int i = path->i;
-  int j = path->j;
-  int temp_i, n = path->n;
-  int* ids_r = path->ids;
-  long double a = 0., b = 0., c = 0., d = 0.;
+  path_swap_commit(path, path->i, path->j,
+                   path_swap_delta(path, path->i, path->j));
+}
 
+/* Chooses two random indexes to swap. */
+void path_random_swap(Path* path, int* i, int* j) {
+  random_indexes(path);
+  *i = path->i;
+  *j = path->j;
+}
+
+/* Computes the cost delta of swapping two indexes. */
+long double path_swap_delta(Path* path, int i, int j) {
+  int a, b, temp, n = path->n;
+  long double before = 0., after = 0.;
+
+  if (i > j)
+    temp = i, i = j, j = temp;
+  a = at(path, i);
+  b = at(path, j);
+
+  if (i-1 >= 0) {
+    before += path_weight_function(path, at(path, i-1), a);
+    after  += path_weight_function(path, at(path, i-1), b);
+  }
+  if (j+1 < n) {
+    before += path_weight_function(path, b, at(path, j+1));
+    after  += path_weight_function(path, a, at(path, j+1));
+  }
+  /* Adjacent cities keep the edge between them. */
+  if (j-i > 1) {
+    before += path_weight_function(path, a, at(path, i+1))
+      + path_weight_function(path, at(path, j-1), b);
+    after  += path_weight_function(path, b, at(path, i+1))
+      + path_weight_function(path, at(path, j-1), a);
+  }
+
+  return after - before;
+}
+
+/* Swaps two indexes of the path, given the cost delta. */
+void path_swap_commit(Path* path, int i, int j, long double delta) {
+  int temp, l = i < j ? i : j, r = i < j ? j : i;
+  if (path->tour) {
+    /* The exchange, as the reversal of the segment between
+       both cities and of its inner part. */
+    tour_reverse(path->tour, l, r);
+    if (r-l > 1)
+      tour_reverse(path->tour, l+1, r-1);
+  } else {
+    temp = *(path->ids + i);
+    *(path->ids + i) = *(path->ids + j);
+    *(path->ids + j) = temp;
+  }
+  path->i = i < j ? i : j;
+  path->j = j > i ? j : i;
+  path->cost_sum += delta;
+}
+
+/* Computes the cost delta of reversing a segment. */
+long double path_two_opt_delta(Path* path, int i, int j) {
+  int temp, n = path->n;
+  long double delta = 0.;
+
+  if (i > j)
+    temp = i, i = j, j = temp;
+
+  /* The weights are symmetric, so the inner edges keep
+     their cost. */
   if (i-1 >= 0)
-    a = path_weight_function(path, *(r_path+i-1),
-                             *(r_path+i));
-  if (i+1 < n)
-    b = path_weight_function(path, *(r_path+i),
-                             *(r_path+i+1));
-
-  if (j-1 >= 0)
-    c = path_weight_function(path, *(r_path+j-1),
-                             *(r_path+j));
+    delta += path_weight_function(path, at(path, i-1), at(path, j))
+      - path_weight_function(path, at(path, i-1), at(path, i));
   if (j+1 < n)
-    d = path_weight_function(path, *(r_path+j),
-                             *(r_path+j+1));
+    delta += path_weight_function(path, at(path, i), at(path, j+1))
+      - path_weight_function(path, at(path, j), at(path, j+1));
+
+  return delta;
+}
+
+/* Reverses a segment of the path, given the cost delta. */
+void path_two_opt_commit(Path* path, int i, int j, long double delta) {
+  int temp, *r_path = path->ids;
+
+  if (i > j)
+    temp = i, i = j, j = temp;
+  path->i = i;
+  path->j = j;
+  if (path->tour)
+    tour_reverse(path->tour, i, j);
+  else
+    reverse(r_path, i, j);
+  path->cost_sum += delta;
+}
 
-  if (abs(i-j) == 1)
-    b = 0.;
+/* Chooses a random segment of 1 to 3 cities to relocate. */
+void path_random_or_opt(Path* path, int* i, int* j, int* k) {
+  int n = path->n, s, p;
+  int l = 1 + rng_bounded(&path->rng, 3);
+
+  l = l < n ? l : n-1;
+  s = rng_bounded(&path->rng, n-l+1);
+  /* A position out of the segment. */
+  p = rng_bounded(&path->rng, n-l);
+  p += p >= s ? l : 0;
+
+  /* Forwards, the segment is the first one; backwards, the
+     second one. */
+  if (p > s)
+    *i = s, *j = s+l, *k = p;
+  else
+    *i = p, *j = s, *k = s+l-1;
+}
 
-  path->cost_sum -= (a+b+c+d);
+/* Chooses two random adjacent segments to exchange. */
+void path_random_three_opt(Path* path, int* i, int* j, int* k) {
+  random_indexes(path);
+  *i = path->i;
+  *j = path->j;
+  *k = *j + rng_bounded(&path->rng, path->n - *j);
+}
 
-  a = 0., b = 0., c = 0., d = 0.;
-  temp = *(r_path + i);
-  temp_i = *(ids_r + i);
-  *(r_path + i) = *(r_path + j);
-  *(ids_r + i) = *(ids_r + j);
+/* Computes the cost delta of exchanging two adjacent segments. */
+long double path_three_opt_delta(Path* path, int i, int j, int k) {
+  int n = path->n;
+  long double delta;
 
-  *(r_path + j) = temp;
-  *(ids_r + j) = temp_i;
+  /* The inner edges of both segments are kept. */
+  delta = path_weight_function(path, at(path, k), at(path, i))
+    - path_weight_function(path, at(path, j-1), at(path, j));
   if (i-1 >= 0)
-    a = path_weight_function(path, *(r_path+i-1),
-                             *(r_path+i));
-  if (i+1 < n)
-    b = path_weight_function(path, *(r_path+i),
-                             *(r_path+i+1));
-
-  if (j-1 >= 0)
-    c = path_weight_function(path, *(r_path+j-1),
-                             *(r_path+j));
-  if (j+1 < n)
-    d = path_weight_function(path, *(r_path+j),
-                             *(r_path+j+1));
+    delta += path_weight_function(path, at(path, i-1), at(path, j))
+      - path_weight_function(path, at(path, i-1), at(path, i));
+  if (k+1 < n)
+    delta += path_weight_function(path, at(path, j-1), at(path, k+1))
+      - path_weight_function(path, at(path, k), at(path, k+1));
 
-  if (abs(i-j) == 1)
-    b = 0.;
+  return delta;
+}
 
-  path->cost_sum += (a+b+c+d);
+/* Exchanges two adjacent segments, given the cost delta. */
+void path_three_opt_commit(Path* path, int i, int j, int k,
+                           long double delta) {
+  /* A rotation, as three reversals. */
+  if (path->tour) {
+    tour_reverse(path->tour, i, j-1);
+    tour_reverse(path->tour, j, k);
+    tour_reverse(path->tour, i, k);
+  } else {
+    reverse(path->ids, i, j-1);
+    reverse(path->ids, j, k);
+    reverse(path->ids, i, k);
+  }
+  path->cost_sum += delta;
+}
+
+/* Reverses the segment between two indexes of the tour. */
+static void reverse(int* ids, int i, int j) {
+  int temp;
+  for (; i < j; ++i, --j) {
+    temp = *(ids+i);
+    *(ids+i) = *(ids+j);
+    *(ids+j) = temp;
+  }
 }
 
 /* Computes the random indexes used by swap function. */
 static void random_indexes(Path* path) {
-  path->i = 0;
-  path->j = 0;
-  while (path->i == path->j)
-    path->i = rand_r(&path->seed)%(path->n), path->j = rand_r(&path->seed)%(path->n);
-  path->i = path->i < path->j ? path->i : path->j;
-  path->j = path->i > path->j ? path->i : path->j;
+  if (path->pair == PAIRS) {
+    rng_pairs(&path->rng, path->n, path->pair_i, path->pair_j, PAIRS);
+    path->pair = 0;
+  }
+  path->i = *(path->pair_i + path->pair);
+  path->j = *(path->pair_j + path->pair++);
 }
 
-/* Returns the city array. */
-City** path_array(Path* path) {
-  return path->r_path;
+/* Returns the city in the i-th position of the path. */
+City* path_city(Path* path, int i) {
+  return *(instance_cities(path->instance) + at(path, i));
 }
 
 /* Returns the sum of the costs of the cities. */
@@ -261,65 +371,20 @@ long double path_sum(Path* path) {
 
 /* Returns the array of ids. */
 int* path_ids(Path* path) {
+  sync(path);
   return path->ids;
 }
 
 /* Returns the maximum distance of the path. */
 double path_max_distance(Path* path) {
-  return path->max_distance;
+  return instance_max_distance(path->instance);
 }
 
-/* Fills the path array. */
-static void fill_path_array(Path* path) {
-  int *ids = path->ids;
+/* Fills the path with the identity permutation. */
+static void fill_identity(Path* path) {
   int i;
   for (i = 0; i < path->n; ++i)
-    *(path->r_path + i) = *(path->cities + *(ids + i));
-}
-
-/* Tells if the edge in the graph exists. */
-static int edge_exists(Path* path, City* c_1, City* c_2) {
-  return (*(*(path->matrix + city_id(c_1))+city_id(c_2))) != 0.0;
-}
-
-/* Computes the maximum distance of the path. */
-static double c_path_max_distance(Path* path) {
-  int* a = path->ids;
-  double (*m)[CITY_NUMBER+1] = path->matrix;
-  int i,j;
-  double max = 0.0;
-  int n = path->n;
-  for (i = 0; i < n; ++i)
-    for (j = i+1; j < n; ++j)
-      max = max < *(*(m+ *(a+i)) + *(a+j)) ? *(*(m+ *(a+i)) + *(a+j)) : max;
-
-  return max;
-}
-
-/* Determines the order of double numbers. */
-static int fequal(const void* n, const void* m) {
-  return *(double*)n-*(double*)m < 0;
-}
-
-/* Computes the normalized path weights. */
-static double c_path_normalize(Path* path) {
-  int i,j,k=0,n=path->n;
-  int* ids = path->ids;
-  City** cities = path->cities;
-  double* distances = path->distances;
-  double sum = 0.0;
-
-  for (i = 0; i < n; ++i)
-    for (j = i+1; j < n; ++j)
-      if (edge_exists(path, *(cities + *(ids+i)), *(cities + *(ids+j)))) {
-        *(distances + k) =  *(*(path->matrix + *(ids+i))+ *(ids+j));
-        ++k;
-      }
-  qsort(distances, n * (n-1)/2, sizeof(double), fequal);
-  for (i = 0; i < n-1; i++)
-    sum += *(distances + i);
-
-  return sum;
+    *(path->ids + i) = i;
 }
 
 /* Returns the number of cities in the path. */
@@ -335,34 +400,30 @@ Path* path_neighbour(Path* path) {
 
 /* Returns a copy of the path. */
 Path* path_copy(Path* path) {
-  Path* copy      = malloc(sizeof(struct _Path));
-  copy->distances = calloc(1,sizeof(double)*path->n*(path->n-1)/2);
-  copy->str       = malloc(sizeof(int)*path->n*2+2);
-  copy->r_path    = city_array(path->n);
-  copy->ids       = calloc(1, sizeof(int)*path->n);
+  Path* copy = path_alloc(path->n);
 
   /* Pointer copy. */
-  copy->cities = path->cities;
-  copy->n      = path->n;
-  copy->seed   = path->seed;
-  copy->matrix = path->matrix;
+  copy->instance   = path->instance;
+  copy->matrix     = path->matrix;
+  copy->normalizer = path->normalizer;
+  copy->rng        = path->rng;
+  copy->pair       = PAIRS;
 
   /* Value copy. */
-  copy->max_distance = path->max_distance;
-  copy->cost_sum     = path->cost_sum;
-  copy->normalized_v = path->normalized_v;
-
-  /* Heap memory intialization. */
-  copy_ids(copy, path->ids);
-  fill_path_array(copy);
+  copy->cost_sum = path->cost_sum;
+  copy->i        = path->i;
+  copy->j        = path->j;
+  memcpy(copy->ids, path_ids(path), sizeof(int)*path->n);
 
   return copy;
 }
 
-/* Copies the ids of one path to another. */
-static void copy_ids(Path* path, int* ids) {
-  for (int i = 0; i < path->n; ++i)
-    *(path->ids + i) = *(ids + i);
+/* Copies the tour of a path into another. */
+void path_copy_to(Path* dst, Path* src) {
+  dst->cost_sum = src->cost_sum;
+  memcpy(dst->ids, path_ids(src), sizeof(int)*src->n);
+  if (dst->tour)
+    tour_set(dst->tour, dst->ids);
 }
 
 /* Returns if the paths are equal. */
@@ -371,34 +432,65 @@ int path_cmp(Path* p_1, Path* p_2) {
     return 0;
   if (p_1->n != p_2->n)
     return 0;
-  if (abs(p_1->cost_sum - p_2->cost_sum) >= 0.00016)
-    return 0;
-  if (abs(p_1->max_distance - p_2->max_distance) >= 0.00016)
+  if (p_1->instance != p_2->instance)
     return 0;
-  if (abs(p_1->normalized_v - p_2->normalized_v) >= 0.00016)
+  if (abs(p_1->cost_sum - p_2->cost_sum) >= 0.00016)
     return 0;
   int i;
-  for(i = 0; i < p_1->n; ++i) {
+  sync(p_1);
+  sync(p_2);
+  for(i = 0; i < p_1->n; ++i)
     if (*(p_1->ids+i) != *(p_2->ids+i))
       return 0;
-    if (!city_cmp(*(p_1->r_path+i),
-                  *(p_2->r_path+i)))
-      return 0;
-  }
   return 1;
 }
 
 /* Returns the string representation of the path */
 char* path_to_str(Path* path) {
   int i;
-  char* str = path->str;
-  City** cities = path->r_path;
+  char* str;
+  int* ids = instance_ids(path->instance);
+  if (!path->str)
+    path->str = malloc(12*path->n+3);
+  str = path->str;
+  sync(path);
   sprintf(str, "%s", "[");
   for (i = 0; i < path->n; ++i) {
-    sprintf(&str[strlen(str)], "%d", city_id(*(cities+i)));
+    sprintf(&str[strlen(str)], "%d", *(ids + *(path->ids+i)));
     if (i+1 < path->n)
       sprintf(&str[strlen(str)], "%s", ",");
   }
   strcat(str, "]");
   return str;
 }
+
+/* Copies the two-level tour, if enabled, into the ids. */
+static void sync(Path* path) {
+  if (path->tour)
+    tour_to_array(path->tour, path->ids);
+}
+
+/* Enables or disables the two-level tour. */
+void path_set_tour(Path* path, int enabled) {
+  if (enabled && !path->tour) {
+    path->tour = tour_new(path->ids, path->n);
+  } else if (!enabled && path->tour) {
+    sync(path);
+    tour_free(path->tour);
+    path->tour = 0;
+  }
+}
+
+/* Returns the city at a position of the path. */
+int path_at(Path* path, int p) {
+  return at(path, p);
+}
+
+/* Returns the position of a city in the path. */
+int path_position(Path* path, int c) {
+  int p;
+  if (path->tour)
+    return tour_position(path->tour, c);
+  for (p = 0; *(path->ids+p) != c; ++p);
+  return p;
+}
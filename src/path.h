@@ -20,15 +20,13 @@
 #pragma once
 
 /**
- * Creates a new Path.
- * @param cities the initial permutation.
- * @param n the number of cities.
- * @param ids the ids of the cities.
+ * Creates a new Path. The instance is not copied, so it
+ * must outlive the path.
+ * @param instance the instance, whose ids are the initial
+ * permutation.
  * @param seed the seed for the RNG.
- * @param matrix the adjacency amtrix.
  */
-Path* path_new(City** cities, int n, int* ids,
-               unsigned int seed, double (*matrix)[CITY_NUMBER+1]);
+Path* path_new(Instance* instance, unsigned int seed);
 
 /**
  * Frees the memory used by the path.
@@ -46,11 +44,11 @@ double path_normalize(Path* path);
 /**
  * Computes the weight of an edge between two cities.
  * @param path the path.
- * @param c_1 the first city.
- * @param c_2 the second city.
+ * @param c_1 the local index of the first city.
+ * @param c_2 the local index of the second city.
  * @return the weight.
  */
-double path_weight_function(Path* path, City* c_1, City* c_2);
+double path_weight_function(Path* path, int c_1, int c_2);
 
 /**
  * Computes the sum of the costs.
@@ -93,11 +91,115 @@ void path_de_swap(Path* path);
 void path_swap_indexes(Path* path, int i, int j);
 
 /**
- * Returns the city array.
+ * Chooses two distinct random indexes, the first one
+ * smaller, to swap or to reverse the segment between them,
+ * without modifying the path.
  * @param path the path.
- * @return the array.
+ * @param i the first index.
+ * @param j the second index.
+ */
+void path_random_swap(Path* path, int* i, int* j);
+
+/**
+ * Computes the change of the cost sum that swapping two
+ * indexes would cause, without modifying the path.
+ * @param path the path.
+ * @param i the first index.
+ * @param j the second index.
+ * @return the cost sum delta.
+ */
+long double path_swap_delta(Path* path, int i, int j);
+
+/**
+ * Swaps two indexes of the path, whose cost sum delta was
+ * computed by `path_swap_delta`. The swap can be undone by
+ * `path_de_swap`.
+ * @param path the path.
+ * @param i the first index.
+ * @param j the second index.
+ * @param delta the cost sum delta.
+ */
+void path_swap_commit(Path* path, int i, int j, long double delta);
+
+/**
+ * Computes the change of the cost sum that reversing the
+ * segment between two indexes would cause, without
+ * modifying the path. Only the two edges at the ends of the
+ * segment change, so the delta takes constant time.
+ * @param path the path.
+ * @param i the first index of the segment.
+ * @param j the last index of the segment.
+ * @return the cost sum delta.
+ */
+long double path_two_opt_delta(Path* path, int i, int j);
+
+/**
+ * Reverses the segment between two indexes of the path,
+ * whose cost sum delta was computed by `path_two_opt_delta`.
+ * Reversing the same segment again undoes the move.
+ * @param path the path.
+ * @param i the first index of the segment.
+ * @param j the last index of the segment.
+ * @param delta the cost sum delta.
+ */
+void path_two_opt_commit(Path* path, int i, int j, long double delta);
+
+/**
+ * Chooses a random segment of 1 to 3 cities and a random
+ * position to relocate it, as the exchange of the segments
+ * [i, j-1] and [j, k], without modifying the path.
+ * @param path the path.
+ * @param i the first index of the first segment.
+ * @param j the first index of the second segment.
+ * @param k the last index of the second segment.
+ */
+void path_random_or_opt(Path* path, int* i, int* j, int* k);
+
+/**
+ * Chooses two random adjacent segments [i, j-1] and [j, k]
+ * to exchange, without modifying the path.
+ * @param path the path.
+ * @param i the first index of the first segment.
+ * @param j the first index of the second segment.
+ * @param k the last index of the second segment.
  */
-City** path_array(Path* path);
+void path_random_three_opt(Path* path, int* i, int* j, int* k);
+
+/**
+ * Computes the change of the cost sum that exchanging the
+ * adjacent segments [i, j-1] and [j, k] would cause, without
+ * modifying the path. This is the 3-opt move that keeps the
+ * orientation of both segments; only the three edges at
+ * their ends change, so the delta takes constant time.
+ * @param path the path.
+ * @param i the first index of the first segment.
+ * @param j the first index of the second segment.
+ * @param k the last index of the second segment.
+ * @return the cost sum delta.
+ */
+long double path_three_opt_delta(Path* path, int i, int j, int k);
+
+/**
+ * Exchanges the adjacent segments [i, j-1] and [j, k] of the
+ * path, whose cost sum delta was computed by
+ * `path_three_opt_delta`. Exchanging the segments
+ * [i, i+k-j] and [i+k-j+1, k] undoes the move.
+ * @param path the path.
+ * @param i the first index of the first segment.
+ * @param j the first index of the second segment.
+ * @param k the last index of the second segment.
+ * @param delta the cost sum delta.
+ */
+void path_three_opt_commit(Path* path, int i, int j, int k,
+                           long double delta);
+
+/**
+ * Returns the city in the i-th position of the path.
+ * @param path the path.
+ * @param i the position.
+ * @return the city.
+ */
+City* path_city(Path* path, int i);
 
 /**
  * Returns the sum of the costs of the cities.
@@ -107,7 +209,8 @@ City** path_array(Path* path);
 long double path_sum(Path* path);
 
 /**
- * Returns the array of ids.
+ * Returns the array of ids, as local indexes of the
+ * instance in tour order.
  * @param path the path.
  * @return the array.
  */
@@ -141,6 +244,14 @@ Path* path_neighbour(Path* path);
  */
 Path* path_copy(Path* path);
 
+/**
+ * Copies the tour of a path into another path of the same
+ * instance, without allocating memory.
+ * @param dst the destination path.
+ * @param src the source path.
+ */
+void path_copy_to(Path* dst, Path* src);
+
 /**
  * Compates two paths.
  * @param p_1 the first path.
@@ -155,3 +266,30 @@ int path_cmp(Path* p_1, Path* p_2);
  * @return the string representation.
  */
 char* path_to_str(Path* path);
+
+/**
+ * Enables or disables the two-level tour of the path. With it,
+ * the moves reverse segments in O(sqrt(n)) instead of O(n),
+ * and the cities are found in O(log n); the array of ids is
+ * only updated when it is requested.
+ * @param path the path.
+ * @param enabled 1 to enable the tour; 0, to disable it.
+ */
+void path_set_tour(Path* path, int enabled);
+
+/**
+ * Returns the city at a position of the path.
+ * @param path the path.
+ * @param p the position.
+ * @return the local index of the city.
+ */
+int path_at(Path* path, int p);
+
+/**
+ * Returns the position of a city in the path. It takes linear
+ * time unless the two-level tour is enabled.
+ * @param path the path.
+ * @param c the local index of the city.
+ * @return the position.
+ */
+int path_position(Path* path, int c);
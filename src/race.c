@@ -0,0 +1,150 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "heuristic.h"
+#include "race.h"
+
+#define INTERVAL    16
+#define CHECKPOINTS 256
+#define RACE_PEERS  3
+#define RACE_MARGIN 0.05
+
+/* The race structure. */
+struct _Race {
+  /* The number of seeds. */
+  int n;
+  /* The quantile a seed must not exceed. */
+  double quantile;
+  /* The number of cooling steps between checkpoints. */
+  int interval;
+  /* The best costs of the seeds at every checkpoint. */
+  double* costs;
+  /* The number of best costs at every checkpoint. */
+  int* counts;
+  /* The best costs of the peers, sorted. */
+  double* sorted;
+  /* The best cost found by any seed. */
+  _Atomic double incumbent;
+  /* The seed of the incumbent. */
+  atomic_uint seed;
+  /* The lock of the means and the updates of the incumbent. */
+  pthread_mutex_t lock;
+};
+
+/* Determines the ascending order of double numbers. */
+static int fascending(const void*, const void*);
+
+/* Creates a new Race. */
+Race* race_new(int n, double quantile, int interval) {
+  /* Heap allocation. */
+  Race* race   = malloc(sizeof(struct _Race));
+  race->costs  = malloc(sizeof(double)*CHECKPOINTS*n);
+  race->counts = calloc(CHECKPOINTS, sizeof(int));
+  race->sorted = malloc(sizeof(double)*n);
+
+  /* Parameters. */
+  race->n        = n;
+  race->quantile = quantile;
+  race->interval = interval ? interval : INTERVAL;
+  atomic_init(&race->incumbent, DBL_MAX);
+  atomic_init(&race->seed, 0);
+  pthread_mutex_init(&race->lock, NULL);
+
+  return race;
+}
+
+/* Frees the memory used by the race. */
+void race_free(Race* race) {
+  pthread_mutex_destroy(&race->lock);
+  free(race->costs);
+  free(race->counts);
+  free(race->sorted);
+  free(race);
+}
+
+/* Returns the checkpoint of a temperature. */
+int race_checkpoint(Race* race, long double t, double epsilon,
+                    double phi) {
+  if (t <= epsilon || phi <= 0 || phi >= 1)
+    return -1;
+  return (int)(logl(t/epsilon)/-logl(phi)/race->interval);
+}
+
+/* Records the best cost of a seed at a checkpoint and decides if
+   it is cut. */
+int race_check(Race* race, int checkpoint, int first, double cost) {
+  double* costs;
+  int k, i, cut = 0;
+
+  if (checkpoint < 0 || checkpoint >= CHECKPOINTS)
+    return 0;
+  costs = race->costs + checkpoint*race->n;
+
+  pthread_mutex_lock(&race->lock);
+  k = *(race->counts + checkpoint);
+  /* The seeds only separate in the cold half of the cooling. */
+  if (k >= RACE_PEERS && 2*checkpoint <= first) {
+    memcpy(race->sorted, costs, sizeof(double)*k);
+    qsort(race->sorted, k, sizeof(double), fascending);
+    /* The index of the quantile, clamped to the sorted costs. */
+    i = (int)(race->quantile*(k-1));
+    i = i < 0 ? 0 : i > k-1 ? k-1 : i;
+    cut = cost > *(race->sorted + i) * (1 + RACE_MARGIN);
+  }
+  if (k < race->n)
+    *(costs + (*(race->counts + checkpoint))++) = cost;
+  pthread_mutex_unlock(&race->lock);
+
+  return cut;
+}
+
+/* Updates the incumbent. Only a better cost takes the lock. */
+void race_update(Race* race, unsigned int seed, double cost) {
+  if (cost >= atomic_load(&race->incumbent))
+    return;
+  pthread_mutex_lock(&race->lock);
+  if (cost < atomic_load(&race->incumbent)) {
+    atomic_store(&race->seed, seed);
+    atomic_store(&race->incumbent, cost);
+  }
+  pthread_mutex_unlock(&race->lock);
+}
+
+/* Returns the incumbent. */
+double race_incumbent(Race* race) {
+  return atomic_load(&race->incumbent);
+}
+
+/* Returns the seed of the incumbent. */
+unsigned int race_incumbent_seed(Race* race) {
+  return atomic_load(&race->seed);
+}
+
+/* Determines the ascending order of double numbers. */
+static int fascending(const void* n, const void* m) {
+  double a = *(double*)n, b = *(double*)m;
+  return (a > b) - (a < b);
+}
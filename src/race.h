@@ -0,0 +1,96 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/**
+ * Creates a new Race between the seeds of a run. The race
+ * keeps the incumbent, the best cost found by any seed, and
+ * the best costs of the seeds at checkpoints of the cooling, so
+ * that a seed that falls behind its peers can be cut early.
+ * @param n the number of seeds.
+ * @param quantile the quantile of the best costs of the peers a
+ * seed must not exceed, in (0, 1].
+ * @param interval the number of cooling steps between
+ * checkpoints, or 0.
+ */
+Race* race_new(int n, double quantile, int interval);
+
+/**
+ * Frees the memory used by the race.
+ * @param race the race.
+ */
+void race_free(Race* race);
+
+/**
+ * Returns the checkpoint of a temperature. The checkpoints are
+ * temperatures, every interval cooling steps of the schedule
+ * counted up from epsilon, so every seed reaches them at the
+ * same temperatures, even if a time limit lowers its phi.
+ * @param race the race.
+ * @param t the temperature.
+ * @param epsilon the final temperature of the schedule.
+ * @param phi the cooling factor of the schedule.
+ * @return the checkpoint, 0 the coldest; or -1 below epsilon.
+ */
+int race_checkpoint(Race* race, long double t, double epsilon,
+                    double phi);
+
+/**
+ * Records the best cost of a seed at a checkpoint and decides
+ * if the seed is cut. Only in the cold half of its cooling,
+ * below half of its first checkpoint, and if at least
+ * RACE_PEERS peers have reached the checkpoint, a best cost
+ * greater than the quantile of theirs by more than RACE_MARGIN
+ * loses; the warmer checkpoints, where the costs of the seeds
+ * are still noise, only record it.
+ * @param race the race.
+ * @param checkpoint the checkpoint the seed reached.
+ * @param first the checkpoint of the initial temperature of
+ * the seed.
+ * @param cost the best cost of the seed.
+ * @return 1 if the seed is cut; 0, otherwise.
+ */
+int race_check(Race* race, int checkpoint, int first, double cost);
+
+/**
+ * Updates the incumbent with the cost of a solution, if it is
+ * better.
+ * @param race the race.
+ * @param seed the seed of the solution.
+ * @param cost the cost of the solution.
+ */
+void race_update(Race* race, unsigned int seed, double cost);
+
+/**
+ * Returns the incumbent, the best cost found by any seed. It
+ * can be read at any moment without locking.
+ * @param race the race.
+ * @return the incumbent.
+ */
+double race_incumbent(Race* race);
+
+/**
+ * Returns the seed of the incumbent.
+ * @param race the race.
+ * @return the seed.
+ */
+unsigned int race_incumbent_seed(Race* race);
@@ -0,0 +1,70 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rng.h"
+
+/* Returns the next word of a splitmix64 sequence. */
+static uint64_t splitmix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/* Seeds a generator. */
+void rng_seed(Rng* rng, uint64_t seed) {
+  uint64_t x = seed / RNG_STREAMS;
+  int i;
+  for (i = 0; i < 4; ++i)
+    *(rng->s+i) = splitmix64(&x);
+  for (i = 0; i < (int)(seed % RNG_STREAMS); ++i)
+    rng_jump(rng);
+}
+
+/* Advances a generator by 2^128 draws. */
+void rng_jump(Rng* rng) {
+  static const uint64_t jump[] = {
+    0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+  };
+  uint64_t s[4] = { 0, 0, 0, 0 };
+  int i, b, k;
+  for (i = 0; i < 4; ++i)
+    for (b = 0; b < 64; ++b) {
+      if (*(jump+i) & (1ULL << b))
+        for (k = 0; k < 4; ++k)
+          *(s+k) ^= *(rng->s+k);
+      rng_next(rng);
+    }
+  for (k = 0; k < 4; ++k)
+    *(rng->s+k) = *(s+k);
+}
+
+/* Fills arrays with pairs of distinct random integers. */
+void rng_pairs(Rng* rng, uint32_t n, int* i, int* j, int count) {
+  int c, a, b;
+  for (c = 0; c < count; ++c) {
+    a = rng_bounded(rng, n);
+    /* The second one skips the first one. */
+    b = rng_bounded(rng, n-1);
+    b += b >= a;
+    *(i+c) = a < b ? a : b;
+    *(j+c) = a < b ? b : a;
+  }
+}
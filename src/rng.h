@@ -0,0 +1,105 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* The number of consecutive seeds that share a base state and
+   are separated by jumps. */
+#define RNG_STREAMS 64
+
+/**
+ * The state of a xoshiro256** generator. It is small and is
+ * kept by value, so every path owns its own stream.
+ */
+typedef struct {
+  uint64_t s[4];
+} Rng;
+
+/**
+ * Seeds a generator. The seeds of a block of RNG_STREAMS
+ * consecutive seeds share a base state, expanded from the
+ * block with splitmix64, and are separated by jumps of 2^128
+ * draws, so their streams never overlap.
+ * @param rng the generator.
+ * @param seed the seed.
+ */
+void rng_seed(Rng* rng, uint64_t seed);
+
+/**
+ * Advances a generator by 2^128 draws.
+ * @param rng the generator.
+ */
+void rng_jump(Rng* rng);
+
+/**
+ * Fills arrays with pairs of distinct random integers in
+ * [0, n), the first one smaller.
+ * @param rng the generator.
+ * @param n the bound; it must be at least 2.
+ * @param i the array of the first integers.
+ * @param j the array of the second integers.
+ * @param count the number of pairs.
+ */
+void rng_pairs(Rng* rng, uint32_t n, int* i, int* j, int count);
+
+/* Rotates a word to the left. */
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Returns the next random word of a generator.
+ * @param rng the generator.
+ * @return the random word.
+ */
+static inline uint64_t rng_next(Rng* rng) {
+  uint64_t* s = rng->s;
+  uint64_t result = rng_rotl(*(s+1) * 5, 7) * 9;
+  uint64_t t = *(s+1) << 17;
+  *(s+2) ^= *s;
+  *(s+3) ^= *(s+1);
+  *(s+1) ^= *(s+2);
+  *s ^= *(s+3);
+  *(s+2) ^= t;
+  *(s+3) = rng_rotl(*(s+3), 45);
+  return result;
+}
+
+/**
+ * Returns an unbiased random integer in [0, n), with the
+ * multiply-and-reject method, which rejects rarely and
+ * avoids the division of the modulo.
+ * @param rng the generator.
+ * @param n the bound; it must be positive.
+ * @return the random integer.
+ */
+static inline uint32_t rng_bounded(Rng* rng, uint32_t n) {
+  uint64_t m = (rng_next(rng) >> 32) * n;
+  uint32_t l = (uint32_t)m, t;
+  if (l < n) {
+    t = -n % n;
+    while (l < t) {
+      m = (rng_next(rng) >> 32) * n;
+      l = (uint32_t)m;
+    }
+  }
+  return m >> 32;
+}
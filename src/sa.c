@@ -19,8 +19,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <float.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "heuristic.h"
 #include "sa.h"
@@ -34,13 +36,23 @@
 #define N         900
 
 #define T_EPSILON 0.00016
+#define S_EPSILON 1e-12
+#define STAGNATION 4
 
 /* The Batch structure. */
 struct _Batch {
   double mean;
   Path* path;
+  /* The number of accepted solutions. */
+  int accepted;
 };
 
+/* A move of the neighbourhood, with its cost sum delta. */
+typedef struct {
+  int i, j, k;
+  long double delta;
+} Move;
+
 /* The Simulated Annealing structure. */
 struct _SA {
   /* The temperature */
@@ -51,11 +63,13 @@ struct _SA {
   double phi;
   /* The current solution */
   Path* sol;
+  /* The best solution found. */
+  Path* best;
   /* Maximum iterations of `compute_batch`
      if no better solution is found.       */
   int m;
-  /* Accepted solutions average and last
-     accepted solution. */
+  /* Accepted solutions average and best
+     accepted solution of the last batch. */
   Batch* batch;
   /* The number of iterations the computing of
      a batch should take.*/
@@ -73,14 +87,121 @@ struct _SA {
   int n_t;
   /* The verbose option. */
   int v;
+  /* The neighbourhood explored. */
+  Neighbourhood neighbourhood;
+  /* The sweep stops at the first improving move of a city,
+     instead of the best one. */
+  int first;
+  /* The maximum number of moves of the sweep, or 0. */
+  long sweep_iterations;
+  /* The maximum time of the sweep in seconds, or 0. */
+  double sweep_time;
+  /* The positions of the cities, for the sweep. */
+  int* pos;
+  /* The queue of cities to visit, for the sweep. */
+  int* queue;
+  /* The cities in the queue, for the sweep. */
+  char* active;
+  /* The number of threads of the sweep. */
+  int sweep_threads;
+  /* If the sweep uses the two-level tour of the path. */
+  int tour;
+  /* The best move of every city, for the parallel sweep. */
+  Move* moves;
+  /* The improving moves, for the parallel sweep. */
+  Move** order;
+  /* The positions changed in the round, for the parallel sweep. */
+  char* taken;
+  /* The Fenwick tree of the first positions of the ranges changed
+     in the round, for the parallel sweep. */
+  int* starts;
+  /* The rounds of the parallel sweep. */
+  pthread_barrier_t barrier;
+  /* If the parallel sweep has finished. */
+  int done;
+  /* The board of the island model, or 0. */
+  Board* board;
+  /* The island of the heuristic in the board. */
+  int island;
+  /* The number of batches between migrations. */
+  int interval;
+  /* The number of batches computed. */
+  long batches;
+  /* The best cost at the last migration. */
+  double published;
+  /* The migrations since the best solution last improved. */
+  int stagnant;
+  /* The race between the seeds, or 0. */
+  Race* race;
+  /* The time limit in seconds, or 0. */
+  double limit;
 };
 
+/* A thread of the parallel sweep, with its range of cities. */
+typedef struct {
+  SA* sa;
+  Path* path;
+  int lo, hi;
+} Sweeper;
+
 /* Returns the percentage of accepted neighbours. */
 static double accepted_percentage(SA*);
 
 /* Computes the intial temperature */
 static long double binary_search(SA*, double, double);
 
+/* Chooses a random move in the neighbourhood. */
+static void move_random(SA*, Path*, int*, int*, int*);
+
+/* Computes the cost sum delta of a move in the neighbourhood. */
+static long double move_delta(SA*, Path*, int, int, int);
+
+/* Applies a move in the neighbourhood. */
+static void move_commit(SA*, Path*, int, int, int, long double);
+
+/* Returns the last third index of the moves of the
+   neighbourhood that start with two indexes. */
+static int move_last(SA*, int, int);
+
+/* Keeps a move if it is valid and better than the given one. */
+static void try_move(SA*, Path*, Move*, int, int, int);
+
+/* Finds the best move that joins a city with a candidate. */
+static void city_moves(SA*, Path*, int, Move*);
+
+/* Returns the position of a city in the path of the sweep. */
+static int position(SA*, Path*, int);
+
+/* Returns the cities at the ends of the segments of a move. */
+static int touched_cities(Path*, Move*, int*);
+
+/* Publishes the best solution and migrates a better one. */
+static void migrate(SA*);
+
+/* Improves the final solution. */
+static Path* serial_sweep(SA*);
+
+/* Improves the final solution with several threads. */
+static Path* parallel_sweep(SA*);
+
+/* Executes a thread of the parallel sweep. */
+static void* sweeper(void*);
+
+/* Finds the best move of the active cities of a range. */
+static void scan_cities(SA*, Path*, int, int);
+
+/* Applies the best improving moves that do not overlap. */
+static long apply_moves(SA*, Path*);
+
+/* Determines the ascending order of the deltas of moves. */
+static int move_cmp(const void*, const void*);
+
+/* Adds a value to a position of the Fenwick tree of the starts. */
+static void starts_add(SA*, int, int);
+
+/* Returns the number of starts up to a position. */
+static int starts_sum(SA*, int);
+
 /* Batch constructor. */
 Batch* batch_new(Path* path) {
   Batch* batch = malloc(sizeof(struct _Batch));
@@ -98,7 +219,7 @@ void batch_free(Batch* batch) {
 /* Creates a new Simulated Annealing Heuristic. */
 SA* sa_new(TSP* tsp, double t, int m, int l,
            double epsilon, double phi, double p,
-           int n_t, int v) {
+           int n_t, int v, Neighbourhood neighbourhood) {
   /* Heap allocation. */
   SA* sa  = malloc(sizeof(struct _SA));
   sa->sol = tsp_path(tsp);
@@ -108,6 +229,7 @@ SA* sa_new(TSP* tsp, double t, int m, int l,
   sa->seed = tsp_seed(tsp);
   sa->tsp  = tsp;
   sa->v    = v;
+  sa->neighbourhood = neighbourhood;
 
   /* Path randomization. */
   path_randomize(sa->sol);
@@ -122,112 +244,416 @@ SA* sa_new(TSP* tsp, double t, int m, int l,
   sa->phi     = phi ? phi : PHI;
   sa->t       = (sa->t == 8) ? initial_temperature(sa) : sa->t;
 
+  /* Solution buffers. */
+  sa->batch  = batch_new(sa->sol);
+  sa->best   = path_copy(sa->sol);
+  sa->pos    = malloc(sizeof(int)*sa->n);
+  sa->queue  = malloc(sizeof(int)*sa->n);
+  sa->active = malloc(sa->n);
+  sa->moves  = malloc(sizeof(Move)*sa->n);
+  sa->order  = malloc(sizeof(Move*)*sa->n);
+  sa->taken  = calloc(sa->n, 1);
+  sa->starts = calloc(sa->n+1, sizeof(int));
+
+  /* Unlimited best-improvement sweep. */
+  sa->first            = 0;
+  sa->sweep_iterations = 0;
+  sa->sweep_time       = 0.;
+  sa->sweep_threads    = 1;
+  sa->tour             = 0;
+
+  /* Single island. */
+  sa->board    = 0;
+  sa->island   = 0;
+  sa->interval = 0;
+  sa->batches  = 0;
+  sa->published = DBL_MAX;
+  sa->stagnant  = 0;
+
+  /* No race nor time limit. */
+  sa->race  = 0;
+  sa->limit = 0.;
+
   return sa;
 }
 
 /* Frees the memory used by the simulated annealing heuristic. */
 void sa_free(SA* sa) {
+  if (sa->batch)
+    batch_free(sa->batch);
+  if (sa->best)
+    path_free(sa->best);
+  free(sa->pos);
+  free(sa->queue);
+  free(sa->active);
+  free(sa->moves);
+  free(sa->order);
+  free(sa->taken);
+  free(sa->starts);
   free(sa);
 }
 
 /* Computes the set of solutions. */
 Batch* compute_batch(SA* sa) {
   long double t = sa->t;
-  Batch* batch = batch_new(sa->sol);
-  int c = 0, m = sa->m;
+  Batch* batch = sa->batch;
+  int c = 0, m = sa->m, i, j, k;
   double r = 0.0;
-  long double cost;
+  long double cost, delta;
 
+  path_copy_to(batch->path, sa->sol);
   while (c < sa->l && m--) {
     cost = path_cost_function(sa->sol);
-    path_swap(sa->sol);
-    if (path_cost_function(sa->sol) <= (cost + t)) {
+    move_random(sa, sa->sol, &i, &j, &k);
+    delta = move_delta(sa, sa->sol, i, j, k);
+    if ((path_sum(sa->sol) + delta)/path_normalize(sa->sol) <= (cost + t)) {
+      move_commit(sa, sa->sol, i, j, k, delta);
       if (sa->v)
         printf("E[%u]:%.16Lf\n", sa->seed, path_cost_function(sa->sol));
       c++;
       r += path_cost_function(sa->sol);
-      if (path_cost_function(sa->sol) < path_cost_function(batch->path)) {
-        path_free(batch->path);
-        batch->path = path_copy(sa->sol);
-      }
+      if (path_cost_function(sa->sol) < path_cost_function(batch->path))
+        path_copy_to(batch->path, sa->sol);
     }
-    else
-      path_de_swap(sa->sol);
   }
   batch->mean = r/sa->l;
+  batch->accepted = c;
+
+  return batch;
+}
 
+/* Computes a batch, keeping the best solution found. */
+Batch* sa_batch(SA* sa) {
+  Batch* batch = compute_batch(sa);
+  if (path_cost_function(batch->path) < path_cost_function(sa->best))
+    path_copy_to(sa->best, batch->path);
   return batch;
 }
 
 /* Main routine to accept solutions. */
 void threshold_accepting(SA* sa) {
-  double p = 0., q;
+  double p = 0., q, phi, left;
+  double start = sa->limit ? wall_clock_seconds() : 0., end, now;
+  /* The race keys its checkpoints on the configured schedule. */
+  double phi_0 = sa->phi;
+  int first = sa->race ? race_checkpoint(sa->race, sa->t, sa->epsilon,
+                                         phi_0) : 0;
+  int last = first, c;
+  long steps = 0;
   Batch* batch;
-  Path* best = path_copy(sa->sol);
+  end = start + SA_ANNEALING*sa->limit;
+  path_copy_to(sa->best, sa->sol);
   printf("T[%u]: %0.16Lf\n", sa->seed, sa->t);
   while (sa->t > sa->epsilon) {
     q = DBL_MAX;
 
     while (p <= q) {
       q = p;
-      batch = compute_batch(sa);
+      batch = sa_batch(sa);
       p = batch->mean;
-      if (path_cost_function(batch->path) < path_cost_function(best)) {
-        path_free(best);
-        best = path_copy(batch->path);
-      }
-      batch_free(batch);
+      if (sa->board && !(++sa->batches % sa->interval))
+        migrate(sa);
+      /* Nothing is accepted at this temperature anymore. */
+      if (!batch->accepted)
+        break;
+      if (sa->limit && wall_clock_seconds() >= end)
+        break;
     }
     sa->t *= sa->phi;
+    ++steps;
+    if (sa->race) {
+      race_update(sa->race, sa->seed, path_cost_function(sa->best));
+      c = race_checkpoint(sa->race, sa->t, sa->epsilon, phi_0);
+      /* The seed lags behind its peers. */
+      if (c < last && (last = c) >= 0
+          && race_check(sa->race, c, first,
+                        path_cost_function(sa->best))) {
+        printf("\nCut[%u]:%.16Lf\n", sa->seed, path_cost_function(sa->best));
+        return;
+      }
+    }
+    if (sa->limit) {
+      /* The cooling steps left must fit in the time left, at the
+         average time of a step so far. */
+      if ((now = wall_clock_seconds()) >= end)
+        break;
+      left = (end - now) / ((now - start) / steps);
+      if (left < 1)
+        break;
+      if (sa->t > sa->epsilon
+          && left < log(sa->epsilon/sa->t)/log(sa->phi)) {
+        /* The cooling is only ever accelerated. */
+        phi = pow(sa->epsilon/sa->t, 1/left);
+        sa->phi = phi < sa->phi ? phi : sa->phi;
+      }
+    }
+  }
+  /* The sweep takes the rest of the time. */
+  if (sa->limit) {
+    now = start + sa->limit - wall_clock_seconds();
+    if (!sa->sweep_time || now < sa->sweep_time)
+      sa->sweep_time = now > S_EPSILON ? now : S_EPSILON;
   }
+  sa_finish(sa);
+}
+
+/* Publishes the best solution in the board and, if the island
+   has stagnated and lags behind the one it migrates from,
+   continues from the solution of that island. An island that
+   still improves keeps its own solution, so the islands do not
+   all collapse onto the best tour after the first migration. */
+static void migrate(SA* sa) {
+  double cost = path_cost_function(sa->best);
+
+  board_publish(sa->board, sa->island, sa->best);
+  sa->stagnant = cost < sa->published ? 0 : sa->stagnant + 1;
+  sa->published = cost;
+  if (sa->stagnant < STAGNATION)
+    return;
+  if (board_migrate(sa->board, sa->island, sa->best))
+    path_copy_to(sa->sol, sa->best);
+  sa->stagnant = 0;
+}
+
+/* Sweeps the best solution found and prints it. */
+void sa_finish(SA* sa) {
+  Path* best = sa->best;
   printf("\nBest[%u]:%.16Lf\n\n\t%s\n", sa->seed, path_cost_function(best), path_to_str(best));
-  path_free(sa->sol);
-  tsp_set_solution(sa->tsp, best);
+  path_copy_to(sa->sol, best);
   sweep(sa);
   printf("\nBest[%u][Sweep]:%.16Lf\n\n\t%s\n", sa->seed, path_cost_function(tsp_path(sa->tsp)),
          path_to_str(tsp_path(sa->tsp)));
+  if (sa->race)
+    race_update(sa->race, sa->seed, path_cost_function(tsp_path(sa->tsp)));
 }
 
 /* Computes the best neighbour of the final solution
-   of the thresold accepting algorithm. */
+   of the thresold accepting algorithm. The solution is
+   improved in place, with the buffers of the heuristic. */
 Path* sweep(SA* sa) {
-  int i, j;
-  Path* copy, *path, *best, *p_best;
+  Path* path = tsp_path(sa->tsp);
+  if (sa->tour)
+    path_set_tour(path, 1);
+  if (sa->sweep_threads > 1)
+    parallel_sweep(sa);
+  else
+    serial_sweep(sa);
+  path_set_tour(path, 0);
+  return path;
+}
 
-  path = tsp_path(sa->tsp);
-  copy = path_copy(path);
-  best = path_copy(path);
-  p_best = 0;
+/* Improves the final solution. Only the moves that join a
+   city with one of its candidates are examined, and only the
+   cities whose edges changed are visited again. */
+static Path* serial_sweep(SA* sa) {
+  Path* path = tsp_path(sa->tsp);
+  int* ids = path_ids(path);
+  int* pos = sa->pos, *queue = sa->queue, touched[9];
+  char* active = sa->active;
+  int a, x, t, h = 0, c = sa->n, n = sa->n;
+  long moves = 0, pops = 0;
+  double start = sa->sweep_time ? wall_clock_seconds() : 0.;
+  Move move;
 
-  do {
-    if (p_best)
-      path_free(p_best);
-    p_best = path_copy(best);
-    for (i = 0; i < sa->n; ++i) {
-      for (j = 0; j < sa->n; ++j) {
-        if (i != j)
-          path_swap_indexes(copy, i, j);
-        if (path_cost_function(copy) < path_cost_function(p_best)) {
-          if (path_cost_function(best) > path_cost_function(copy)) {
-            if (sa->v)
-              printf("E[%u]:%.16Lf\n", sa->seed, path_cost_function(copy));
-            path_free(best);
-            best = path_copy(copy);
-          }
-        }
-        if (i != j)
-          path_de_swap(copy);
+  /* Every city starts in the queue, in tour order. */
+  for (x = 0; x < n; ++x) {
+    *(pos + *(ids+x)) = x;
+    *(queue+x) = *(ids+x);
+    *(active+x) = 1;
+  }
+
+  while (c) {
+    if (sa->sweep_iterations && moves >= sa->sweep_iterations)
+      break;
+    /* The clock is read every few cities. */
+    if (sa->sweep_time && !(++pops & 0xff) &&
+        wall_clock_seconds() - start >= sa->sweep_time)
+      break;
+
+    a = *(queue+h);
+    h = (h+1)%n, --c;
+    *(active+a) = 0;
+
+    move.delta = 0.;
+    city_moves(sa, path, a, &move);
+    if (move.delta/path_normalize(path) >= -S_EPSILON)
+      continue;
+
+    /* The cities at the ends of the changed segments. */
+    t = touched_cities(path, &move, touched);
+    move_commit(sa, path, move.i, move.j, move.k, move.delta);
+    for (x = move.i; !sa->tour && x <= move.k; ++x)
+      *(pos + *(ids+x)) = x;
+    ++moves;
+    if (sa->v)
+      printf("E[%u]:%.16Lf\n", sa->seed, path_cost_function(path));
+
+    *(touched+t++) = a;
+    while (t--)
+      if (!*(active + *(touched+t))) {
+        *(active + *(touched+t)) = 1;
+        *(queue + (h+c)%n) = *(touched+t);
+        ++c;
       }
+  }
+
+  return path;
+}
+
+/* Improves the final solution with several threads. In every
+   round, each thread finds the best move of the active cities
+   of its range on the unchanged tour; then the best moves whose
+   segments do not overlap are applied together. */
+static Path* parallel_sweep(SA* sa) {
+  Path* path = tsp_path(sa->tsp);
+  int* ids = path_ids(path);
+  int x, n = sa->n, t = sa->sweep_threads < n ? sa->sweep_threads : n;
+  long moves = 0, m;
+  double start = sa->sweep_time ? wall_clock_seconds() : 0.;
+  pthread_t th[t];
+  Sweeper sweepers[t];
+
+  for (x = 0; x < n; ++x) {
+    *(sa->pos + *(ids+x)) = x;
+    *(sa->active+x) = 1;
+  }
+
+  sa->done = 0;
+  pthread_barrier_init(&sa->barrier, NULL, t);
+  for (x = 0; x < t; ++x) {
+    (sweepers+x)->sa   = sa;
+    (sweepers+x)->path = path;
+    (sweepers+x)->lo   = x*n/t;
+    (sweepers+x)->hi   = (x+1)*n/t;
+    if (x && pthread_create(th+x, NULL, sweeper, sweepers+x)) {
+      fprintf(stderr, "Thread could not be created.");
+      exit(1);
+    }
+  }
+
+  do {
+    /* The first range is scanned by this thread. */
+    pthread_barrier_wait(&sa->barrier);
+    scan_cities(sa, path, sweepers->lo, sweepers->hi);
+    pthread_barrier_wait(&sa->barrier);
+
+    m = apply_moves(sa, path);
+    moves += m;
+    if (!m || (sa->sweep_iterations && moves >= sa->sweep_iterations) ||
+        (sa->sweep_time && wall_clock_seconds() - start >= sa->sweep_time))
+      sa->done = 1;
+  } while (!sa->done);
+
+  pthread_barrier_wait(&sa->barrier);
+  for (x = 1; x < t; ++x)
+    if (pthread_join(*(th+x), NULL)) {
+      fprintf(stderr, "Thread could not be joined.");
+      exit(1);
     }
-    path_free(copy);
-    copy = path_copy(best);
-  } while (fabs(path_cost_function(best) - path_cost_function(p_best)) > T_EPSILON);
+  pthread_barrier_destroy(&sa->barrier);
 
-  path_free(path);
-  tsp_set_solution(sa->tsp, best);
-  path_free(p_best);
-  path_free(copy);
-  return best;
+  return path;
+}
+
+/* Executes a thread of the parallel sweep. */
+static void* sweeper(void* v_sweeper) {
+  Sweeper* sweeper = (Sweeper*)v_sweeper;
+  SA* sa = sweeper->sa;
+  while (1) {
+    pthread_barrier_wait(&sa->barrier);
+    if (sa->done)
+      break;
+    scan_cities(sa, sweeper->path, sweeper->lo, sweeper->hi);
+    pthread_barrier_wait(&sa->barrier);
+  }
+  return 0;
+}
+
+/* Finds the best move of the active cities of a range. */
+static void scan_cities(SA* sa, Path* path, int lo, int hi) {
+  int a;
+  for (a = lo; a < hi; ++a) {
+    (sa->moves+a)->delta = 0.;
+    if (*(sa->active+a))
+      city_moves(sa, path, a, sa->moves+a);
+  }
+}
+
+/* Applies the best improving moves that do not overlap, and
+   returns their number. A move only reads and changes the
+   positions from i-1 to k+1, so moves on disjoint ranges are
+   independent. A range overlaps the applied ones if one of its
+   ends is taken or an applied range starts inside it, which
+   takes O(log n). The cities without improving moves are not
+   visited again until a neighbour changes. */
+static long apply_moves(SA* sa, Path* path) {
+  int* ids = sa->tour ? 0 : path_ids(path), *spans = sa->queue;
+  int touched[9];
+  int a, b, c = 0, s = 0, x, y, t, n = sa->n;
+  long applied = 0;
+  Move* move;
+
+  for (a = 0; a < sa->n; ++a)
+    if ((sa->moves+a)->delta/path_normalize(path) < -S_EPSILON)
+      *(sa->order + c++) = sa->moves+a;
+    else
+      *(sa->active+a) = 0;
+  qsort(sa->order, c, sizeof(Move*), move_cmp);
+
+  /* The applied ranges, as pairs of positions. */
+  for (x = 0; x < c; ++x) {
+    move = *(sa->order+x);
+    a = move->i-1 > 0 ? move->i-1 : 0;
+    b = move->k+1 < n ? move->k+1 : n-1;
+    if (*(sa->taken+a) || *(sa->taken+b) ||
+        starts_sum(sa, b) - starts_sum(sa, a-1) || s+2 > n)
+      continue;
+    *(spans+s++) = a;
+    *(spans+s++) = b;
+    memset(sa->taken+a, 1, b-a+1);
+    starts_add(sa, a, 1);
+
+    t = touched_cities(path, move, touched);
+    move_commit(sa, path, move->i, move->j, move->k, move->delta);
+    for (y = move->i; !sa->tour && y <= move->k; ++y)
+      *(sa->pos + *(ids+y)) = y;
+    ++applied;
+    if (sa->v)
+      printf("E[%u]:%.16Lf\n", sa->seed, path_cost_function(path));
+
+    *(touched+t++) = move - sa->moves;
+    while (t--)
+      *(sa->active + *(touched+t)) = 1;
+  }
+
+  /* The marks are cleared for the next round. */
+  for (y = 0; y < s; y += 2) {
+    memset(sa->taken + *(spans+y), 0, *(spans+y+1) - *(spans+y) + 1);
+    starts_add(sa, *(spans+y), -1);
+  }
+
+  return applied;
+}
+
+/* Adds a value to a position of the Fenwick tree of the starts. */
+static void starts_add(SA* sa, int p, int v) {
+  for (++p; p <= sa->n; p += p & -p)
+    *(sa->starts+p) += v;
+}
+
+/* Returns the number of starts up to a position, or 0 if it is
+   negative. */
+static int starts_sum(SA* sa, int p) {
+  int sum = 0;
+  for (++p; p > 0; p -= p & -p)
+    sum += *(sa->starts+p);
+  return sum;
+}
+
+/* Determines the ascending order of the deltas of moves. */
+static int move_cmp(const void* a, const void* b) {
+  long double d_1 = (*(Move**)a)->delta, d_2 = (*(Move**)b)->delta;
+  return (d_1 > d_2) - (d_1 < d_2);
 }
 
 /* Computes the initial temperature. */
@@ -256,19 +682,18 @@ long double initial_temperature(SA* sa) {
 
 /* Returns the percentage of accepted neighbours. */
 static double accepted_percentage(SA* sa) {
-  int c = 0, i;
-  Path* n;
-  for (i = 0; i < N; ++i) {
-    n = path_copy(sa->sol);
-    path_swap(sa->sol);
-    if (path_cost_function(sa->sol) <= (path_cost_function(n) + sa->t))
+  int c = 0, x, i, j, k;
+  long double cost, delta;
+  for (x = 0; x < N; ++x) {
+    cost = path_cost_function(sa->sol);
+    move_random(sa, sa->sol, &i, &j, &k);
+    delta = move_delta(sa, sa->sol, i, j, k);
+    if ((path_sum(sa->sol) + delta)/path_normalize(sa->sol) <= (cost + sa->t)) {
+      move_commit(sa, sa->sol, i, j, k, delta);
       c++;
-    else
-      path_de_swap(sa->sol);
-    path_free(n);
+    }
   }
   return (double)c/N;
-
 }
 
 /* Computes the intial temperature */
@@ -285,11 +710,206 @@ static long double binary_search(SA* sa, double t_1, double t_2) {
     return binary_search(sa, t_m, t_2);
 }
 
+/* Chooses a random move in the neighbourhood. The moves on
+   two indexes ignore the third one. */
+static void move_random(SA* sa, Path* path, int* i, int* j, int* k) {
+  switch (sa->neighbourhood) {
+  case NEIGHBOURHOOD_OR_OPT:
+    path_random_or_opt(path, i, j, k);
+    break;
+  case NEIGHBOURHOOD_THREE_OPT:
+    path_random_three_opt(path, i, j, k);
+    break;
+  default:
+    path_random_swap(path, i, j);
+    *k = *j;
+    break;
+  }
+}
+
+/* Computes the cost sum delta of a move in the neighbourhood. */
+static long double move_delta(SA* sa, Path* path, int i, int j, int k) {
+  switch (sa->neighbourhood) {
+  case NEIGHBOURHOOD_TWO_OPT:
+    return path_two_opt_delta(path, i, j);
+  case NEIGHBOURHOOD_OR_OPT:
+  case NEIGHBOURHOOD_THREE_OPT:
+    return path_three_opt_delta(path, i, j, k);
+  default:
+    return path_swap_delta(path, i, j);
+  }
+}
+
+/* Applies a move in the neighbourhood. */
+static void move_commit(SA* sa, Path* path, int i, int j, int k,
+                        long double delta) {
+  switch (sa->neighbourhood) {
+  case NEIGHBOURHOOD_TWO_OPT:
+    path_two_opt_commit(path, i, j, delta);
+    break;
+  case NEIGHBOURHOOD_OR_OPT:
+  case NEIGHBOURHOOD_THREE_OPT:
+    path_three_opt_commit(path, i, j, k, delta);
+    break;
+  default:
+    path_swap_commit(path, i, j, delta);
+    break;
+  }
+}
+
+/* Returns the last third index of the moves of the
+   neighbourhood that start with two indexes. */
+static int move_last(SA* sa, int i, int j) {
+  switch (sa->neighbourhood) {
+  case NEIGHBOURHOOD_OR_OPT:
+    /* One of the segments has at most 3 cities. */
+    if (j-i <= 3)
+      return sa->n-1;
+    return j+2 < sa->n ? j+2 : sa->n-1;
+  case NEIGHBOURHOOD_THREE_OPT:
+    return sa->n-1;
+  default:
+    return j;
+  }
+}
+
+/* Keeps a move if it is valid and better than the given one. */
+static void try_move(SA* sa, Path* path, Move* move, int i, int j, int k) {
+  long double delta;
+  if (i < 0 || i >= j || k < j || k >= sa->n || k > move_last(sa, i, j))
+    return;
+  delta = move_delta(sa, path, i, j, k);
+  if (delta < move->delta)
+    move->i = i, move->j = j, move->k = k, move->delta = delta;
+}
+
+/* Finds the best move that joins a city with a candidate. For
+   the segment exchanges, the third index is also taken from the
+   candidates, or from the shortest segments. */
+static void city_moves(SA* sa, Path* path, int a, Move* move) {
+  Instance* instance = tsp_instance(sa->tsp);
+  int k = instance_candidate_number(instance);
+  int* candidates = instance_candidates(instance);
+  int* d, *e;
+  int x = position(sa, path, a), p, u, v, i, j, l;
+
+  for (d = candidates + a*k; d < candidates + (a+1)*k; ++d) {
+    if (sa->first && move->delta < 0.)
+      return;
+    p = position(sa, path, *d);
+    u = x < p ? x : p;
+    v = x < p ? p : x;
+    switch (sa->neighbourhood) {
+    case NEIGHBOURHOOD_TWO_OPT:
+      try_move(sa, path, move, u+1, v, v);
+      try_move(sa, path, move, u, v-1, v-1);
+      break;
+    case NEIGHBOURHOOD_OR_OPT:
+    case NEIGHBOURHOOD_THREE_OPT:
+      /* The city at u followed by the one at v. */
+      i = u+1, j = v;
+      if (i < j) {
+        for (l = j; l < j+3; ++l)
+          try_move(sa, path, move, i, j, l);
+        for (e = candidates + path_at(path, i)*k;
+             e < candidates + (path_at(path, i)+1)*k; ++e)
+          try_move(sa, path, move, i, j, position(sa, path, *e));
+      }
+      /* The city at u preceding the one at v. */
+      j = u+1, l = v-1;
+      if (j <= l) {
+        for (i = j-3; i < j; ++i)
+          try_move(sa, path, move, i, j, l);
+        for (e = candidates + path_at(path, l)*k;
+             e < candidates + (path_at(path, l)+1)*k; ++e)
+          try_move(sa, path, move, position(sa, path, *e), j, l);
+      }
+      break;
+    default:
+      /* One of the cities next to the other one. */
+      for (l = -1; l <= 1; l += 2) {
+        i = x+l < p ? x+l : p;
+        j = x+l < p ? p : x+l;
+        try_move(sa, path, move, i, j, j);
+        i = p+l < x ? p+l : x;
+        j = p+l < x ? x : p+l;
+        try_move(sa, path, move, i, j, j);
+      }
+      break;
+    }
+  }
+}
+
+/* Returns the position of a city in the path of the sweep: from
+   the two-level tour, if enabled; from the positions array,
+   otherwise. */
+static int position(SA* sa, Path* path, int c) {
+  return sa->tour ? path_position(path, c) : *(sa->pos+c);
+}
+
+/* Returns the cities at the ends of the segments of a move. */
+static int touched_cities(Path* path, Move* move, int* touched) {
+  int n = path_n(path), t = 0;
+  int x[] = { move->i-1, move->i, move->i+1, move->j-1,
+              move->j, move->j+1, move->k, move->k+1 };
+  int y;
+  for (y = 0; y < 8; ++y)
+    if (*(x+y) >= 0 && *(x+y) < n)
+      *(touched+t++) = path_at(path, *(x+y));
+  return t;
+}
+
+/* Sets the limits of the sweep. */
+void sa_set_sweep(SA* sa, int first, long iterations, double time,
+                  int threads) {
+  sa->first            = first;
+  sa->sweep_iterations = iterations;
+  sa->sweep_time       = time;
+  sa->sweep_threads    = threads > 1 ? threads : 1;
+}
+
+/* Sets if the sweep uses the two-level tour of the path. */
+void sa_set_sweep_tour(SA* sa, int tour) {
+  sa->tour = tour;
+}
+
+/* Sets the board of the island model. */
+void sa_set_board(SA* sa, Board* board, int island, int interval) {
+  sa->board    = board;
+  sa->island   = island;
+  sa->interval = interval;
+}
+
+/* Sets the time limit of the heuristic. */
+void sa_set_time_limit(SA* sa, double limit) {
+  sa->limit = limit;
+}
+
+/* Sets the race between the seeds. */
+void sa_set_race(SA* sa, Race* race) {
+  sa->race = race;
+}
+
+/* Returns the best solution found by the heuristic. */
+Path* sa_best(SA* sa) {
+  return sa->best;
+}
+
 /* Returns the temperature of the heuristic. */
 long double sa_temperature(SA* sa) {
   return sa->t;
 }
 
+/* Returns the epsilon of the heuristic. */
+double sa_epsilon(SA* sa) {
+  return sa->epsilon;
+}
+
+/* Returns the phi of the heuristic. */
+double sa_phi(SA* sa) {
+  return sa->phi;
+}
+
 /* Sets the temperature of the heuristic. */
 void sa_set_temperature(SA* sa, long double t) {
   sa->t = t;
@@ -19,6 +19,10 @@
 
 #pragma once
 
+/* The share of a time limit spent annealing; the final sweep
+   takes the rest. */
+#define SA_ANNEALING 0.9
+
 /**
  * Creates a new Simulated Annealing Heuristic.
  * @param tsp the TSP instance.
@@ -33,10 +37,11 @@
  * @param n the number of iterations the computing of
  * `accepted_percentage` should take.
  * @param v the verbose option.
+ * @param neighbourhood the neighbourhood explored.
  */
 SA* sa_new(TSP* tsp, double t, int m, int l,
            double epsilon, double phi, double p,
-           int n, int v);
+           int n, int v, Neighbourhood neighbourhood);
 
 /**
  * Frees the memory used by the simulated annealing
@@ -48,19 +53,37 @@ void sa_free(SA* sa);
 /**
  * Computes the set of solutions.
  * @param sa the heuristic.
- * @return the batch.
+ * @return the batch, owned by the heuristic and reused by
+ * the next call.
  */
 Batch* compute_batch(SA* sa);
 
+/**
+ * Computes a batch at the current temperature and keeps its
+ * best solution if it is the best one found.
+ * @param sa the heuristic.
+ * @return the batch, owned by the heuristic and reused by
+ * the next call.
+ */
+Batch* sa_batch(SA* sa);
+
 /**
  * Main routine to accept solutions.
  * @param sa the heuristic.
  */
 void threshold_accepting(SA* sa);
 
+/**
+ * Prints the best solution found, improves it with the sweep
+ * and prints the result.
+ * @param sa the heuristic.
+ */
+void sa_finish(SA* sa);
+
 /**
  * Computes the best neighbour of the final solution
- * of the thresold accepting algorithm.
+ * of the thresold accepting algorithm, improving it in
+ * place without allocating memory.
  * @param sa the heuristic.
  * @return the best neighbour.
  */
@@ -74,6 +97,13 @@ Path* sweep(SA* sa);
 long double initial_temperature(SA* sa);
 
 
+/**
+ * Returns the best solution found by the heuristic.
+ * @param sa the heuristic.
+ * @return the best solution.
+ */
+Path* sa_best(SA* sa);
+
 /**
  * Returns the temperature of the heuristic.
  * @param sa the heuristic.
@@ -81,9 +111,83 @@ long double initial_temperature(SA* sa);
  */
 long double sa_temperature(SA* sa);
 
+/**
+ * Returns the epsilon of the heuristic, the temperature where
+ * `threshold_accepting` ends.
+ * @param sa the heuristic.
+ * @return the epsilon.
+ */
+double sa_epsilon(SA* sa);
+
+/**
+ * Returns the phi of the heuristic. Under a time limit,
+ * `threshold_accepting` lowers it whenever the cooling steps
+ * left would not fit.
+ * @param sa the heuristic.
+ * @return the phi.
+ */
+double sa_phi(SA* sa);
+
 /**
  * Sets the temperature of the heuristic.
  * @param sa the heuristic.
  * @param t the new temperature.
  */
 void sa_set_temperature(SA* sa, long double t);
+
+/**
+ * Sets the limits of the sweep. By default, the sweep applies
+ * the best improving move of every city until none is left.
+ * @param sa the heuristic.
+ * @param first if the first improving move of a city is
+ * applied instead of the best one.
+ * @param iterations the maximum number of moves, or 0.
+ * @param time the maximum time in seconds, or 0.
+ * @param threads the number of threads that scan the moves
+ * of the cities; with more than one, the best moves that do
+ * not overlap are applied together in rounds.
+ */
+void sa_set_sweep(SA* sa, int first, long iterations, double time,
+                  int threads);
+
+/**
+ * Sets if the sweep uses the two-level tour of the path, whose
+ * reversals take O(sqrt(n)) instead of O(n), for instances of
+ * thousands of cities.
+ * @param sa the heuristic.
+ * @param tour 1 to use the two-level tour; 0, otherwise.
+ */
+void sa_set_sweep_tour(SA* sa, int tour);
+
+/**
+ * Sets the board of the island model. Every given number of
+ * batches, the heuristic publishes its best solution in its
+ * slot; once its best solution has not improved for a few of
+ * these migrations, if the solution it migrates from is better,
+ * it continues from it.
+ * @param sa the heuristic.
+ * @param board the board, or 0 for a single island.
+ * @param island the island of the heuristic.
+ * @param interval the number of batches between migrations.
+ */
+void sa_set_board(SA* sa, Board* board, int island, int interval);
+
+/**
+ * Sets the race between the seeds. The heuristic updates the
+ * incumbent of the race after every cooling step and after the
+ * sweep, and stops without sweeping when the race cuts it.
+ * @param sa the heuristic.
+ * @param race the race, or 0.
+ */
+void sa_set_race(SA* sa, Race* race);
+
+/**
+ * Sets the time limit of `threshold_accepting`. The annealing
+ * takes at most 90% of it: the cooling is accelerated whenever
+ * the cooling steps left, at the average time of a step so
+ * far, would not fit; the sweep is truncated to the rest. The
+ * best solution so far is kept in `sa_best` at every moment.
+ * @param sa the heuristic.
+ * @param limit the time limit in seconds, or 0.
+ */
+void sa_set_time_limit(SA* sa, double limit);
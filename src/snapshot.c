@@ -0,0 +1,38 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Converts the database into a binary snapshot. */
+int main(int argc, char** argv) {
+  char* path = argc > 1 ? *(argv + 1) : SNAPSHOT_PATH;
+  int status;
+
+  Database_loader* loader = loader_new();
+  loader_open(loader);
+  loader_load(loader);
+  status = loader_write_snapshot(loader, path);
+  loader_unref(loader);
+
+  if (status)
+    printf("Snapshot written: %s\n", path);
+  return !status;
+}
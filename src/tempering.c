@@ -0,0 +1,235 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "heuristic.h"
+#include "tempering.h"
+
+#define ROUNDS 250
+
+/* The parallel tempering structure. */
+struct _Tempering {
+  /* The number of replicas. */
+  int r;
+  /* The number of batches of every replica. */
+  int rounds;
+  /* The problem instances of the replicas. */
+  TSP** tsps;
+  /* The heuristics of the replicas. */
+  SA** sas;
+  /* The temperatures of the ladder, hottest first. */
+  long double* ladder;
+  /* The replica at every temperature of the ladder. */
+  int* rung;
+  /* The generator of the exchanges. */
+  Rng rng;
+  /* The number of accepted exchanges. */
+  long exchanges;
+  /* The rounds of batches and exchanges. */
+  pthread_barrier_t barrier;
+  /* The time limit in seconds, or 0. */
+  double limit;
+  /* The time the rounds end, if there is a time limit. */
+  double end;
+  /* If the rounds have ended before the last one. */
+  int stop;
+};
+
+/* A thread of the parallel tempering, with its replica. */
+typedef struct {
+  Tempering* tempering;
+  int j;
+} Replica;
+
+/* Executes the batches of a replica. */
+static void* replica(void*);
+
+/* Exchanges the solutions of adjacent temperatures. */
+static void exchange(Tempering*, int);
+
+/* Creates a new parallel tempering. */
+Tempering* tempering_new(Instance* instance, unsigned int seed, int r,
+                         int rounds, double t, int m, int l,
+                         double epsilon, double phi, double p, int n_t,
+                         int v, Neighbourhood neighbourhood) {
+  long double t_max, t_min;
+  int j;
+  /* Heap allocation. */
+  Tempering* tempering = malloc(sizeof(struct _Tempering));
+  tempering->tsps   = malloc(sizeof(TSP*)*r);
+  tempering->sas    = malloc(sizeof(SA*)*r);
+  tempering->ladder = malloc(sizeof(long double)*r);
+  tempering->rung   = malloc(sizeof(int)*r);
+
+  /* Parameters. */
+  tempering->r         = r;
+  tempering->rounds    = rounds ? rounds : ROUNDS;
+  tempering->exchanges = 0;
+  tempering->limit     = 0.;
+  tempering->stop      = 0;
+  rng_seed(&tempering->rng, seed);
+
+  /* The first replica computes the initial temperature. */
+  for (j = 0; j < r; ++j) {
+    *(tempering->tsps+j) = tsp_new(instance, seed+j);
+    *(tempering->sas+j) = sa_new(*(tempering->tsps+j),
+                                 j ? sa_temperature(*tempering->sas) : t,
+                                 m, l, epsilon, phi, p, n_t, v,
+                                 neighbourhood);
+  }
+
+  /* Geometric ladder. Its coldest rung is the temperature the
+     annealing reaches some cooling steps before epsilon: cold
+     enough to improve, but not frozen, so it still takes
+     exchanges. */
+  t_max = sa_temperature(*tempering->sas);
+  t_min = sa_epsilon(*tempering->sas)
+    / powl(sa_phi(*tempering->sas), TEMPERING_COLD_STEPS);
+  t_min = t_min < t_max ? t_min : t_max;
+  for (j = 0; j < r; ++j) {
+    *(tempering->ladder+j) = t_max * powl(t_min/t_max, (long double)j/(r-1));
+    *(tempering->rung+j) = j;
+    sa_set_temperature(*(tempering->sas+j), *(tempering->ladder+j));
+    printf("T[%u]: %0.16Lf\n", seed+j, *(tempering->ladder+j));
+  }
+
+  pthread_barrier_init(&tempering->barrier, NULL, r);
+  return tempering;
+}
+
+/* Frees the memory used by the parallel tempering. */
+void tempering_free(Tempering* tempering) {
+  int j;
+  for (j = 0; j < tempering->r; ++j) {
+    sa_free(*(tempering->sas+j));
+    tsp_free(*(tempering->tsps+j));
+  }
+  pthread_barrier_destroy(&tempering->barrier);
+  free(tempering->tsps);
+  free(tempering->sas);
+  free(tempering->ladder);
+  free(tempering->rung);
+  free(tempering);
+}
+
+/* Runs the replicas of the parallel tempering. */
+SA* tempering_run(Tempering* tempering) {
+  int j, r = tempering->r, b = 0;
+  pthread_t th[r];
+  Replica replicas[r];
+
+  tempering->end = wall_clock_seconds() + SA_ANNEALING*tempering->limit;
+  for (j = 0; j < r; ++j) {
+    (replicas+j)->tempering = tempering;
+    (replicas+j)->j = j;
+    if (pthread_create(th+j, NULL, replica, replicas+j)) {
+      fprintf(stderr, "Thread could not be created.");
+      exit(1);
+    }
+  }
+  for (j = 0; j < r; ++j)
+    if (pthread_join(*(th+j), NULL)) {
+      fprintf(stderr, "Thread could not be joined.");
+      exit(1);
+    }
+
+  for (j = 1; j < r; ++j)
+    if (path_cost_function(sa_best(*(tempering->sas+j)))
+        < path_cost_function(sa_best(*(tempering->sas+b))))
+      b = j;
+  return *(tempering->sas+b);
+}
+
+/* Sets the time limit of the parallel tempering. */
+void tempering_set_time_limit(Tempering* tempering, double limit) {
+  tempering->limit = limit;
+}
+
+/* Returns a temperature of the ladder. */
+long double tempering_temperature(Tempering* tempering, int k) {
+  return *(tempering->ladder+k);
+}
+
+/* Returns the replica at a temperature of the ladder. */
+int tempering_replica(Tempering* tempering, int k) {
+  return *(tempering->rung+k);
+}
+
+/* Returns the heuristic of a replica. */
+SA* tempering_sa(Tempering* tempering, int j) {
+  return *(tempering->sas+j);
+}
+
+/* Returns the number of accepted exchanges. */
+long tempering_exchanges(Tempering* tempering) {
+  return tempering->exchanges;
+}
+
+/* Executes the batches of a replica. Between batches, one
+   thread exchanges the solutions while the others wait. */
+static void* replica(void* v_replica) {
+  Replica* replica = (Replica*)v_replica;
+  Tempering* tempering = replica->tempering;
+  SA* sa = *(tempering->sas + replica->j);
+  int i;
+
+  for (i = 0; i < tempering->rounds && !tempering->stop; ++i) {
+    sa_batch(sa);
+    if (pthread_barrier_wait(&tempering->barrier)
+        == PTHREAD_BARRIER_SERIAL_THREAD) {
+      exchange(tempering, i % 2);
+      if (tempering->limit && wall_clock_seconds() >= tempering->end)
+        tempering->stop = 1;
+    }
+    pthread_barrier_wait(&tempering->barrier);
+  }
+  return 0;
+}
+
+/* Exchanges the solutions of the adjacent temperatures that
+   start at the given parity, with the probability
+   min(1, exp((1/t_a - 1/t_b)(E_a - E_b))). The temperatures
+   are exchanged instead of the solutions, which is equivalent
+   and takes O(1). */
+static void exchange(Tempering* tempering, int parity) {
+  int a, b, k;
+  long double e_a, e_b, x;
+  double u;
+
+  for (k = parity; k+1 < tempering->r; k += 2) {
+    a = *(tempering->rung+k);
+    b = *(tempering->rung+k+1);
+    e_a = path_cost_function(tsp_path(*(tempering->tsps+a)));
+    e_b = path_cost_function(tsp_path(*(tempering->tsps+b)));
+    x = (1/(*(tempering->ladder+k)) - 1/(*(tempering->ladder+k+1)))
+      * (e_a - e_b);
+    u = (rng_next(&tempering->rng) >> 11) * 0x1.0p-53;
+    if (x >= 0 || u < expl(x)) {
+      *(tempering->rung+k)   = b;
+      *(tempering->rung+k+1) = a;
+      sa_set_temperature(*(tempering->sas+a), *(tempering->ladder+k+1));
+      sa_set_temperature(*(tempering->sas+b), *(tempering->ladder+k));
+      tempering->exchanges++;
+    }
+  }
+}
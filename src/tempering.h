@@ -0,0 +1,111 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/* The cooling steps before epsilon at which the annealing
+   reaches the coldest temperature of the ladder. */
+#define TEMPERING_COLD_STEPS 50
+
+/**
+ * Creates a new parallel tempering of an instance: r replicas
+ * of the heuristic, each one on its own thread, anneal at a
+ * ladder of fixed temperatures that decreases geometrically
+ * from the initial temperature to the coldest one, the one the
+ * annealing reaches `TEMPERING_COLD_STEPS` cooling steps before
+ * epsilon, epsilon/phi^TEMPERING_COLD_STEPS; and the
+ * solutions of adjacent temperatures are exchanged between
+ * batches.
+ * The replica j uses the seed `seed + j`.
+ * @param instance the shared instance.
+ * @param seed the first seed.
+ * @param r the number of replicas, at least 2.
+ * @param rounds the number of batches of every replica, or 0.
+ * @param t the initial temperature, or 0.
+ * @param m maximum iterations of `compute_batch`.
+ * @param l the number of accepted solutions of a batch.
+ * @param epsilon the final temperature of the annealing, or 0.
+ * @param phi the cooling factor of the annealing, or 0.
+ * @param p percentage of accepted solutions.
+ * @param n_t the number of iterations the computing of
+ * the initial temperature should take.
+ * @param v the verbose option.
+ * @param neighbourhood the neighbourhood explored.
+ */
+Tempering* tempering_new(Instance* instance, unsigned int seed, int r,
+                         int rounds, double t, int m, int l,
+                         double epsilon, double phi, double p, int n_t,
+                         int v, Neighbourhood neighbourhood);
+
+/**
+ * Frees the memory used by the parallel tempering.
+ * @param tempering the parallel tempering.
+ */
+void tempering_free(Tempering* tempering);
+
+/**
+ * Runs the replicas of the parallel tempering.
+ * @param tempering the parallel tempering.
+ * @return the heuristic of the replica that found the best
+ * solution, owned by the parallel tempering.
+ */
+SA* tempering_run(Tempering* tempering);
+
+/**
+ * Sets the time limit of the parallel tempering. The rounds
+ * stop after 90% of it, leaving the rest to the sweep.
+ * @param tempering the parallel tempering.
+ * @param limit the time limit in seconds, or 0.
+ */
+void tempering_set_time_limit(Tempering* tempering, double limit);
+
+/**
+ * Returns a temperature of the ladder of the parallel tempering.
+ * @param tempering the parallel tempering.
+ * @param k the position in the ladder, hottest first.
+ * @return the temperature.
+ */
+long double tempering_temperature(Tempering* tempering, int k);
+
+/**
+ * Returns the replica at a temperature of the ladder of the
+ * parallel tempering.
+ * @param tempering the parallel tempering.
+ * @param k the position in the ladder, hottest first.
+ * @return the replica.
+ */
+int tempering_replica(Tempering* tempering, int k);
+
+/**
+ * Returns the heuristic of a replica of the parallel tempering.
+ * @param tempering the parallel tempering.
+ * @param j the replica.
+ * @return the heuristic, owned by the parallel tempering.
+ */
+SA* tempering_sa(Tempering* tempering, int j);
+
+/**
+ * Returns the number of accepted exchanges of the parallel
+ * tempering.
+ * @param tempering the parallel tempering.
+ * @return the number of exchanges.
+ */
+long tempering_exchanges(Tempering* tempering);
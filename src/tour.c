@@ -0,0 +1,246 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "heuristic.h"
+#include "tour.h"
+
+/* A block of the tour: a slice of the buffer, which may be
+   traversed backwards. */
+typedef struct {
+  /* The first index of the slice in the buffer. */
+  int start;
+  /* The number of cities. */
+  int len;
+  /* If the slice is traversed backwards. */
+  int rev;
+  /* The position of the first city of the block. */
+  int pos;
+} Block;
+
+/* The tour structure. */
+struct _Tour {
+  /* The number of cities. */
+  int n;
+  /* The cities, sliced by the blocks. */
+  int* buffer;
+  /* The index of every city in the buffer. */
+  int* where;
+  /* The block of every index of the buffer. */
+  int* block_of;
+  /* The blocks. */
+  Block* blocks;
+  /* The blocks, in tour order. */
+  int* order;
+  /* The number of blocks in the tour. */
+  int s;
+  /* The number of cities of a new block. */
+  int size;
+  /* The number of blocks before the tour is rebuilt. */
+  int max;
+  /* An array of n cities, to rebuild the tour. */
+  int* scratch;
+};
+
+/* Returns the rank of the block that holds a position. */
+static int find(Tour*, int);
+
+/* Makes a position the first one of a block. */
+static void split_at(Tour*, int);
+
+/* Creates a new Tour. */
+Tour* tour_new(int* ids, int n) {
+  /* Heap allocation. */
+  Tour* tour     = malloc(sizeof(struct _Tour));
+  tour->n        = n;
+  tour->size     = (int)sqrt(n) > 0 ? (int)sqrt(n) : 1;
+  tour->max      = 2*((n + tour->size - 1)/tour->size) + 4;
+  tour->buffer   = malloc(sizeof(int)*(n+1));
+  tour->where    = malloc(sizeof(int)*(n+1));
+  tour->block_of = malloc(sizeof(int)*(n+1));
+  tour->scratch  = malloc(sizeof(int)*(n+1));
+  tour->blocks   = malloc(sizeof(Block)*tour->max);
+  tour->order    = malloc(sizeof(int)*tour->max);
+
+  tour_set(tour, ids);
+  return tour;
+}
+
+/* Frees the memory used by the tour. */
+void tour_free(Tour* tour) {
+  free(tour->buffer);
+  free(tour->where);
+  free(tour->block_of);
+  free(tour->scratch);
+  free(tour->blocks);
+  free(tour->order);
+  free(tour);
+}
+
+/* Sets the order of the cities of the tour, in blocks of the
+   same size. */
+void tour_set(Tour* tour, int* ids) {
+  int x, b;
+  if (ids != tour->buffer)
+    memcpy(tour->buffer, ids, sizeof(int)*tour->n);
+  for (x = 0; x < tour->n; ++x) {
+    *(tour->where + *(tour->buffer+x)) = x;
+    *(tour->block_of+x) = x/tour->size;
+  }
+
+  tour->s = (tour->n + tour->size - 1)/tour->size;
+  for (b = 0; b < tour->s; ++b) {
+    (tour->blocks+b)->start = b*tour->size;
+    (tour->blocks+b)->pos   = b*tour->size;
+    (tour->blocks+b)->rev   = 0;
+    (tour->blocks+b)->len   = b+1 < tour->s ?
+      tour->size : tour->n - b*tour->size;
+    *(tour->order+b) = b;
+  }
+}
+
+/* Copies the order of the cities of the tour into an array. */
+void tour_to_array(Tour* tour, int* ids) {
+  int r, x, p = 0;
+  Block* block;
+  for (r = 0; r < tour->s; ++r) {
+    block = tour->blocks + *(tour->order+r);
+    if (block->rev)
+      for (x = block->start + block->len - 1; x >= block->start; --x)
+        *(ids + p++) = *(tour->buffer+x);
+    else
+      for (x = block->start; x < block->start + block->len; ++x)
+        *(ids + p++) = *(tour->buffer+x);
+  }
+}
+
+/* Returns the rank of the block that holds a position. */
+static int find(Tour* tour, int p) {
+  int lo = 0, hi = tour->s - 1, mid;
+  while (lo < hi) {
+    mid = (lo + hi + 1)/2;
+    if ((tour->blocks + *(tour->order+mid))->pos <= p)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/* Returns the city at a position of the tour. */
+int tour_city(Tour* tour, int p) {
+  Block* block = tour->blocks + *(tour->order + find(tour, p));
+  int off = p - block->pos;
+  return *(tour->buffer + (block->rev ?
+                           block->start + block->len - 1 - off :
+                           block->start + off));
+}
+
+/* Returns the position of a city in the tour. */
+int tour_position(Tour* tour, int c) {
+  int x = *(tour->where+c);
+  Block* block = tour->blocks + *(tour->block_of+x);
+  return block->pos + (block->rev ?
+                       block->start + block->len - 1 - x :
+                       x - block->start);
+}
+
+/* Returns the city after a city in the tour. */
+int tour_next(Tour* tour, int c) {
+  int p = tour_position(tour, c);
+  return p+1 < tour->n ? tour_city(tour, p+1) : -1;
+}
+
+/* Returns the city before a city in the tour. */
+int tour_prev(Tour* tour, int c) {
+  int p = tour_position(tour, c);
+  return p ? tour_city(tour, p-1) : -1;
+}
+
+/* Returns if a city lies between two others in the tour. */
+int tour_between(Tour* tour, int a, int b, int c) {
+  int p = tour_position(tour, a), q = tour_position(tour, b),
+    r = tour_position(tour, c);
+  return (p <= q && q <= r) || (r <= q && q <= p);
+}
+
+/* Makes a position the first one of a block, moving the rest
+   of its block into a new one. */
+static void split_at(Tour* tour, int p) {
+  int r = find(tour, p), x, b = tour->s;
+  Block* block = tour->blocks + *(tour->order+r);
+  Block* right = tour->blocks + b;
+  int off = p - block->pos;
+
+  if (!off)
+    return;
+  right->rev = block->rev;
+  right->pos = p;
+  right->len = block->len - off;
+  if (block->rev) {
+    right->start = block->start;
+    block->start += right->len;
+  } else
+    right->start = block->start + off;
+  block->len = off;
+
+  for (x = right->start; x < right->start + right->len; ++x)
+    *(tour->block_of+x) = b;
+  memmove(tour->order+r+2, tour->order+r+1, sizeof(int)*(tour->s-r-1));
+  *(tour->order+r+1) = b;
+  tour->s++;
+}
+
+/* Reverses the segment between two positions of the tour: the
+   blocks between them are reversed in order and direction. */
+void tour_reverse(Tour* tour, int i, int j) {
+  int r_i, r_j, t, p, temp;
+  Block* block;
+
+  if (i > j)
+    t = i, i = j, j = t;
+  if (i == j)
+    return;
+  /* Every split adds a block; the tour is rebuilt before the
+     blocks become too many. */
+  if (tour->s + 2 > tour->max) {
+    tour_to_array(tour, tour->scratch);
+    tour_set(tour, tour->scratch);
+  }
+  split_at(tour, i);
+  if (j+1 < tour->n)
+    split_at(tour, j+1);
+
+  r_i = find(tour, i);
+  r_j = find(tour, j);
+  for (t = r_i, p = r_j; t < p; ++t, --p) {
+    temp = *(tour->order+t);
+    *(tour->order+t) = *(tour->order+p);
+    *(tour->order+p) = temp;
+  }
+  for (t = r_i, p = i; t <= r_j; ++t) {
+    block = tour->blocks + *(tour->order+t);
+    block->rev = !block->rev;
+    block->pos = p;
+    p += block->len;
+  }
+}
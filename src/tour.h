@@ -0,0 +1,103 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "heuristic.h"
+
+/**
+ * Creates a new Tour: an open path of cities stored as a list
+ * of blocks of about sqrt(n) cities, each of which may be
+ * reversed. Positions and cities are found in O(log n) and a
+ * segment is reversed in amortized O(sqrt(n)).
+ * @param ids the cities, in path order.
+ * @param n the number of cities; the cities must be 0..n-1.
+ */
+Tour* tour_new(int* ids, int n);
+
+/**
+ * Frees the memory used by the tour.
+ * @param tour the tour.
+ */
+void tour_free(Tour* tour);
+
+/**
+ * Sets the order of the cities of the tour.
+ * @param tour the tour.
+ * @param ids the cities, in path order.
+ */
+void tour_set(Tour* tour, int* ids);
+
+/**
+ * Copies the order of the cities of the tour into an array.
+ * @param tour the tour.
+ * @param ids the array, which must hold n cities.
+ */
+void tour_to_array(Tour* tour, int* ids);
+
+/**
+ * Returns the city at a position of the tour.
+ * @param tour the tour.
+ * @param p the position.
+ * @return the city.
+ */
+int tour_city(Tour* tour, int p);
+
+/**
+ * Returns the position of a city in the tour.
+ * @param tour the tour.
+ * @param c the city.
+ * @return the position.
+ */
+int tour_position(Tour* tour, int c);
+
+/**
+ * Returns the city after a city in the tour.
+ * @param tour the tour.
+ * @param c the city.
+ * @return the next city, or -1 if c is the last one.
+ */
+int tour_next(Tour* tour, int c);
+
+/**
+ * Returns the city before a city in the tour.
+ * @param tour the tour.
+ * @param c the city.
+ * @return the previous city, or -1 if c is the first one.
+ */
+int tour_prev(Tour* tour, int c);
+
+/**
+ * Returns if a city lies between two others in the tour,
+ * in either direction.
+ * @param tour the tour.
+ * @param a the first city.
+ * @param b the city.
+ * @param c the second city.
+ * @return 1, if b is between a and c; 0, otherwise.
+ */
+int tour_between(Tour* tour, int a, int b, int c);
+
+/**
+ * Reverses the segment between two positions of the tour.
+ * @param tour the tour.
+ * @param i the first position.
+ * @param j the last position.
+ */
+void tour_reverse(Tour* tour, int i, int j);
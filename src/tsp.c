@@ -32,44 +32,25 @@
 struct _TSP {
   /*The best solution */
   Path* path;
-  /* The database loader. */
-  Database_loader* loader;
+  /* The shared instance. */
+  Instance* instance;
   /* The seed. */
   unsigned int seed;
-  /* The number of cities in this instance. */
-  int n;
-  /* The ids of the cities in this instance. */
-  int *ids;
-  /* The filled adjacency matrix. */
-  double (*fm)[CITY_NUMBER+1];
-  /* RNG buffer. */
-  struct drand48_data* buffer;
 };
 
 /* Creates a new TSP instance. */
-TSP* tsp_new(int n, int* ids, unsigned int seed) {
+TSP* tsp_new(Instance* instance, unsigned int seed) {
   /* Heap allocation. */
   TSP* tsp         = malloc(sizeof( struct _TSP));
-  tsp->ids         = calloc(1,sizeof(int)*n);
-  tsp->fm          = calloc(1,(CITY_NUMBER+1)*sizeof(double[CITY_NUMBER+1]));
 
   /* Random number generator. */
   tsp->seed        = seed;
 
-  /* Database intialization. */
-  tsp->loader = loader_new();
-  loader_open(tsp->loader);
-  loader_load(tsp->loader);
-
-  /* Value copies. */
-  tsp->n = n;
-
-  /* Heap memory intialization. */
-  memcpy(tsp->ids, ids, tsp->n * sizeof(int));
+  /* Shared instance. */
+  tsp->instance = instance_ref(instance);
 
   /* Structure creation. */
-  tsp->path   = path_new(loader_cities(tsp->loader), n, ids,
-                         tsp->seed, loader_adj_matrix(tsp->loader));
+  tsp->path   = path_new(tsp->instance, tsp->seed);
 
   return tsp;
 }
@@ -78,33 +59,29 @@ TSP* tsp_new(int n, int* ids, unsigned int seed) {
 void tsp_free(TSP* tsp) {
   if (tsp->path)
     path_free(tsp->path);
-  if (tsp->fm)
-    free(tsp->fm);
-  if (tsp->ids)
-    free(tsp->ids);
-  if (tsp->loader)
-    loader_free(tsp->loader);
+  if (tsp->instance)
+    instance_unref(tsp->instance);
   free(tsp);
 }
 
-/* Returns the database loader of the TSP instance. */
-Database_loader* tsp_database_loader(TSP* tsp) {
-  return tsp->loader;
+/* Returns the shared instance of the TSP instance. */
+Instance* tsp_instance(TSP* tsp) {
+  return tsp->instance;
 }
 
-/* Returns the adjacency matrix of the TSP instance. */
-double (*tsp_adj_matrix(TSP* tsp))[CITY_NUMBER+1] {
-  return loader_adj_matrix(tsp->loader);
+/* Returns the database loader of the TSP instance. */
+Database_loader* tsp_database_loader(TSP* tsp) {
+  return instance_loader(tsp->instance);
 }
 
 /* Returns the ids array of the TSP instance. */
 int* tsp_ids(TSP* tsp) {
-  return tsp->ids;
+  return instance_ids(tsp->instance);
 }
 
 /* Returns the number of cities in the TSP instance. */
 int tsp_city_number(TSP* tsp) {
-  return tsp->n;
+  return instance_n(tsp->instance);
 }
 
 /* Returns the path of the TSP instance. */
@@ -121,8 +98,3 @@ unsigned int tsp_seed(TSP* tsp) {
 void tsp_set_solution(TSP* tsp, Path* path) {
   tsp->path = path;
 }
-
-/* Sets the database loader of the TSP instance. */
-void tsp_set_database_loader(TSP* tsp, Database_loader* loader) {
-  tsp->loader = loader;
-}
@@ -21,11 +21,10 @@
 
 /**
  * Creates a new TSP instance.
- * @param n the number of cities.
- * @param ids the ids of the cities.
+ * @param instance the shared instance.
  * @param seed the requested seed.
  */
-TSP* tsp_new(int n, int* ids, unsigned int seed);
+TSP* tsp_new(Instance* instance, unsigned int seed);
 
 /**
  * Frees the memory used by the tsp instance.
@@ -34,18 +33,18 @@ TSP* tsp_new(int n, int* ids, unsigned int seed);
 void tsp_free(TSP* tsp);
 
 /**
- * Returns the database loader of the TSP instance.
+ * Returns the shared instance of the TSP instance.
  * @param tsp the TSP instance.
- * @return the database loader of the TSP instance.
+ * @return the shared instance.
  */
-Database_loader* tsp_database_loader(TSP* tsp);
+Instance* tsp_instance(TSP* tsp);
 
 /**
- * Returns the adjacency matrix of the TSP instance.
+ * Returns the database loader of the TSP instance.
  * @param tsp the TSP instance.
- * @return the adjacency matrix.
+ * @return the database loader of the TSP instance.
  */
-double (*tsp_adj_matrix(TSP* tsp))[CITY_NUMBER+1];
+Database_loader* tsp_database_loader(TSP* tsp);
 
 /**
  * Returns the ids array of the TSP instance.
@@ -81,10 +80,3 @@ unsigned int tsp_seed(TSP* tsp);
  * @param current the current solution.
  */
 void tsp_set_solution(TSP* tsp, Path* path);
-
-/**
- * Sets the database loader of the TSP instance.
- * @param tsp the TSP instance.
- * @param loader the database loader.
- */
-void tsp_set_database_loader(TSP* tsp, Database_loader* loader);
@@ -0,0 +1,38 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <time.h>
+
+#include "wall_clock.h"
+
+/* Returns the time of the monotonic wall clock in seconds. */
+double wall_clock_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/* Returns the share of the time left of a worker for its next
+   seed. */
+double wall_clock_share(double end, int left, int pool) {
+  double rest = end - wall_clock_seconds();
+  double share = rest / ((left + pool - 1)/pool);
+  return share > 1e-9 ? share : 1e-9;
+}
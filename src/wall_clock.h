@@ -0,0 +1,40 @@
+/*
+ * This file is part of TSP_SA.
+ *
+ * Copyright © 2023 Diego Sebastián Sánchez Correa
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+/**
+ * Returns the time of the monotonic wall clock, shared by every
+ * time limit of the program.
+ * @return the time in seconds.
+ */
+double wall_clock_seconds();
+
+/**
+ * Returns the share of the time left of a worker for its next
+ * seed: the time left divided by the rounds the worker still
+ * runs, if the seeds left are divided evenly between the
+ * workers.
+ * @param end the time the run must end.
+ * @param left the number of seeds left, the next one included.
+ * @param pool the number of workers.
+ * @return the time in seconds, at least 1e-9.
+ */
+double wall_clock_share(double end, int left, int pool);
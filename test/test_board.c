@@ -0,0 +1,197 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Instance values. */
+#define NUM_CITIES 40
+#define ISLANDS    3
+
+/* Predefined instance. */
+static int instance[40] = {
+  1,2,3,4,5,6,7,54,163,164,165,168,172,186,327,329,331,332,
+  333,483,489,490,491,492,493,496,653,654,656,657,815,816,
+  817,820,978,979,980,981,982,984
+};
+
+/* Test environment. */
+typedef struct {
+  unsigned int seed;
+  Database_loader* loader;
+  Instance* instance;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  test_env->loader = loader_new();
+  loader_open(test_env->loader);
+  loader_load_ids(test_env->loader, NUM_CITIES, instance);
+  test_env->instance = instance_new(test_env->loader, NUM_CITIES,
+                                    instance);
+  test_env->seed = time(0);
+  return test_env;
+}
+
+/* Test board. */
+typedef struct {
+  Board* board;
+  /* Three random paths, from the best to the worst. */
+  Path* paths[ISLANDS];
+} Test_board;
+
+/* Sets up a board test case, with the topology of its data. */
+static void test_board_set_up(Test_board* test_board,
+                              Test_env* test_env, Topology topology) {
+  Path* path;
+  int i, j;
+
+  test_board->board = board_new(test_env->instance, ISLANDS, topology);
+  for (i = 0; i < ISLANDS; ++i) {
+    path = path_new(test_env->instance, test_env->seed + i);
+    path_randomize(path);
+    for (j = i; j > 0 && path_cost_function(path) <
+           path_cost_function(*(test_board->paths+j-1)); --j)
+      *(test_board->paths+j) = *(test_board->paths+j-1);
+    *(test_board->paths+j) = path;
+  }
+}
+
+/* Sets up a board test case with a ring. */
+static void test_board_set_up_ring(Test_board* test_board,
+                                   gconstpointer data) {
+  test_board_set_up(test_board, (Test_env*)data, TOPOLOGY_RING);
+}
+
+/* Sets up a board test case with a broadcast. */
+static void test_board_set_up_broadcast(Test_board* test_board,
+                                        gconstpointer data) {
+  test_board_set_up(test_board, (Test_env*)data, TOPOLOGY_BROADCAST);
+}
+
+/* Tears down a board test case. */
+static void test_board_tear_down(Test_board* test_board,
+                                 gconstpointer data) {
+  int i;
+  for (i = 0; i < ISLANDS; ++i)
+    path_free(*(test_board->paths+i));
+  board_free(test_board->board);
+}
+
+/* Tests that nothing migrates from an empty board. */
+static void test_board_empty(Test_board* test_board,
+                             gconstpointer data) {
+  Path* worst = *(test_board->paths+ISLANDS-1);
+  Path* copy = path_copy(worst);
+  int i;
+
+  for (i = 0; i < ISLANDS; ++i)
+    g_assert_cmpint(board_migrate(test_board->board, i, copy), ==, 0);
+  g_assert_true(path_cmp(copy, worst));
+  path_free(copy);
+}
+
+/* Tests that an island of a ring migrates the better solution of
+   its predecessor, and only of its predecessor. */
+static void test_board_ring(Test_board* test_board,
+                            gconstpointer data) {
+  Path* best = *(test_board->paths);
+  Path* worst = *(test_board->paths+ISLANDS-1);
+  Path* copy = path_copy(worst);
+
+  board_publish(test_board->board, 0, best);
+  g_assert_cmpint(board_migrate(test_board->board, 2, copy), ==, 0);
+  g_assert_true(path_cmp(copy, worst));
+  g_assert_cmpint(board_migrate(test_board->board, 1, copy), ==, 1);
+  g_assert_true(path_cmp(copy, best));
+  /* The island already has the solution of its predecessor. */
+  g_assert_cmpint(board_migrate(test_board->board, 1, copy), ==, 0);
+  path_free(copy);
+}
+
+/* Tests that a worse solution does not replace a published one. */
+static void test_board_publish(Test_board* test_board,
+                               gconstpointer data) {
+  Path* best = *(test_board->paths);
+  Path* worst = *(test_board->paths+ISLANDS-1);
+  Path* copy = path_copy(worst);
+
+  board_publish(test_board->board, 0, best);
+  board_publish(test_board->board, 0, worst);
+  g_assert_cmpint(board_migrate(test_board->board, 1, copy), ==, 1);
+  g_assert_true(path_cmp(copy, best));
+  path_free(copy);
+}
+
+/* Tests that an island of a broadcast migrates the best solution
+   of the other islands. */
+static void test_board_broadcast(Test_board* test_board,
+                                 gconstpointer data) {
+  Path* best = *(test_board->paths);
+  Path* middle = *(test_board->paths+1);
+  Path* worst = *(test_board->paths+ISLANDS-1);
+  Path* copy = path_copy(worst);
+
+  board_publish(test_board->board, 1, middle);
+  board_publish(test_board->board, 2, best);
+  g_assert_cmpint(board_migrate(test_board->board, 0, copy), ==, 1);
+  g_assert_true(path_cmp(copy, best));
+  /* The island does not migrate its own solution. */
+  path_copy_to(copy, worst);
+  g_assert_cmpint(board_migrate(test_board->board, 2, copy), ==, 1);
+  g_assert_true(path_cmp(copy, middle));
+  path_free(copy);
+}
+
+/* Tests that nothing migrates from a retired island. */
+static void test_board_retire(Test_board* test_board,
+                              gconstpointer data) {
+  Path* best = *(test_board->paths);
+  Path* worst = *(test_board->paths+ISLANDS-1);
+  Path* copy = path_copy(worst);
+
+  board_publish(test_board->board, 0, best);
+  board_retire(test_board->board, 0);
+  g_assert_cmpint(board_migrate(test_board->board, 1, copy), ==, 0);
+  g_assert_true(path_cmp(copy, worst));
+  /* The next seed of the island publishes again. */
+  board_publish(test_board->board, 0, worst);
+  board_publish(test_board->board, 0, best);
+  g_assert_cmpint(board_migrate(test_board->board, 1, copy), ==, 1);
+  g_assert_true(path_cmp(copy, best));
+  path_free(copy);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env* test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/board/test_board_empty", Test_board, test_env,
+             test_board_set_up_ring,
+             test_board_empty,
+             test_board_tear_down);
+  g_test_add("/board/test_board_ring", Test_board, test_env,
+             test_board_set_up_ring,
+             test_board_ring,
+             test_board_tear_down);
+  g_test_add("/board/test_board_publish", Test_board, test_env,
+             test_board_set_up_ring,
+             test_board_publish,
+             test_board_tear_down);
+  g_test_add("/board/test_board_broadcast", Test_board, test_env,
+             test_board_set_up_broadcast,
+             test_board_broadcast,
+             test_board_tear_down);
+  g_test_add("/board/test_board_retire", Test_board, test_env,
+             test_board_set_up_ring,
+             test_board_retire,
+             test_board_tear_down);
+
+  return g_test_run();
+}
@@ -0,0 +1,176 @@
+#define _XOPEN_SOURCE 700
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "heuristic.h"
+
+/* Test processors. */
+typedef struct {
+  /* The directory of the fixture files. */
+  char dir[64];
+  /* The fixture /proc/self/cgroup and /proc/self/mountinfo. */
+  char cgroup[96];
+  char mountinfo[96];
+} Test_cpu;
+
+/* Writes a fixture file under the directory of the test, creating
+   its parent directories. */
+static void write_file(Test_cpu* test_cpu, const char* name,
+                       const char* content) {
+  char path[256], *p;
+  FILE* f;
+
+  snprintf(path, sizeof(path), "%s/%s", test_cpu->dir, name);
+  for (p = strchr(path + strlen(test_cpu->dir) + 1, '/'); p;
+       p = strchr(p + 1, '/')) {
+    *p = 0;
+    mkdir(path, 0700);
+    *p = '/';
+  }
+  f = fopen(path, "w");
+  g_assert_true(f != NULL);
+  fputs(content, f);
+  fclose(f);
+}
+
+/* Writes the fixture mountinfo with a mount of a hierarchy. */
+static void write_mountinfo(Test_cpu* test_cpu, const char* root,
+                            const char* mount, const char* type,
+                            const char* options) {
+  char line[512];
+
+  snprintf(line, sizeof(line),
+           "24 1 0:22 / /sys rw,nosuid - sysfs sysfs rw\n"
+           "35 24 0:30 %s %s/%s rw,relatime - %s %s %s\n",
+           root, test_cpu->dir, mount, type, type, options);
+  write_file(test_cpu, "mountinfo", line);
+}
+
+/* Removes a fixture file. */
+static int remove_file(const char* path, const struct stat* st,
+                       int flag, struct FTW* ftw) {
+  return remove(path);
+}
+
+/* Sets up a processors test case. */
+static void test_cpu_set_up(Test_cpu* test_cpu, gconstpointer data) {
+  strcpy(test_cpu->dir, "/tmp/test_cpu_XXXXXX");
+  g_assert_true(mkdtemp(test_cpu->dir) != NULL);
+  snprintf(test_cpu->cgroup, sizeof(test_cpu->cgroup), "%s/cgroup",
+           test_cpu->dir);
+  snprintf(test_cpu->mountinfo, sizeof(test_cpu->mountinfo),
+           "%s/mountinfo", test_cpu->dir);
+}
+
+/* Tears down a processors test case. */
+static void test_cpu_tear_down(Test_cpu* test_cpu, gconstpointer data) {
+  nftw(test_cpu->dir, remove_file, 8, FTW_DEPTH | FTW_PHYS);
+}
+
+/* Tests that the v2 quota is read from the cgroup of the process,
+   not from the root of the hierarchy. */
+static void test_cpu_cgroup_v2(Test_cpu* test_cpu, gconstpointer data) {
+  write_file(test_cpu, "cgroup", "0::/a/b\n");
+  write_mountinfo(test_cpu, "/", "v2", "cgroup2", "rw");
+  write_file(test_cpu, "v2/cpu.max", "max 100000\n");
+  write_file(test_cpu, "v2/a/b/cpu.max", "150000 100000\n");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 2);
+  write_file(test_cpu, "v2/a/b/cpu.max", "max 100000\n");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 0);
+}
+
+/* Tests that the quota of an ancestor bounds the one of the
+   cgroup. */
+static void test_cpu_cgroup_ancestor(Test_cpu* test_cpu,
+                                     gconstpointer data) {
+  write_file(test_cpu, "cgroup", "0::/a/b\n");
+  write_mountinfo(test_cpu, "/", "v2", "cgroup2", "rw");
+  write_file(test_cpu, "v2/a/cpu.max", "100000 100000\n");
+  write_file(test_cpu, "v2/a/b/cpu.max", "400000 100000\n");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 1);
+}
+
+/* Tests that the v1 quota is read from the hierarchy of the cpu
+   controller, wherever it is mounted. */
+static void test_cpu_cgroup_v1(Test_cpu* test_cpu, gconstpointer data) {
+  write_file(test_cpu, "cgroup",
+             "5:memory:/x\n4:cpu,cpuacct:/x\n0::/\n");
+  write_mountinfo(test_cpu, "/", "v1", "cgroup", "rw,cpu,cpuacct");
+  write_file(test_cpu, "v1/x/cpu.cfs_quota_us", "250000\n");
+  write_file(test_cpu, "v1/x/cpu.cfs_period_us", "100000\n");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 3);
+}
+
+/* Tests that the cgroup is resolved under a mount that only shows
+   a subtree of the hierarchy. */
+static void test_cpu_cgroup_root(Test_cpu* test_cpu, gconstpointer data) {
+  write_file(test_cpu, "cgroup", "0::/x/y\n");
+  write_mountinfo(test_cpu, "/x", "v2", "cgroup2", "rw");
+  write_file(test_cpu, "v2/y/cpu.max", "50000 100000\n");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 1);
+}
+
+/* Tests that there is no quota without the cgroup files. */
+static void test_cpu_cgroup_missing(Test_cpu* test_cpu,
+                                    gconstpointer data) {
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 0);
+  write_file(test_cpu, "cgroup", "0::/a\n");
+  write_mountinfo(test_cpu, "/", "v1", "cgroup", "rw,memory");
+  g_assert_cmpint(cpu_cgroup_quota(test_cpu->cgroup,
+                                   test_cpu->mountinfo), ==, 0);
+}
+
+/* Tests that the pool has one worker per processor, but no more
+   than the seeds. */
+static void test_cpu_pool_size(Test_cpu* test_cpu, gconstpointer data) {
+  int n = cpu_count();
+
+  g_assert_cmpint(n, >=, 1);
+  g_assert_cmpint(n, <=, cpu_count_mask());
+  g_assert_cmpint(cpu_pool_size(1), ==, 1);
+  g_assert_cmpint(cpu_pool_size(n), ==, n);
+  g_assert_cmpint(cpu_pool_size(n + 100), ==, n);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add("/cpu/test_cpu_cgroup_v2", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_cgroup_v2,
+             test_cpu_tear_down);
+  g_test_add("/cpu/test_cpu_cgroup_ancestor", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_cgroup_ancestor,
+             test_cpu_tear_down);
+  g_test_add("/cpu/test_cpu_cgroup_v1", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_cgroup_v1,
+             test_cpu_tear_down);
+  g_test_add("/cpu/test_cpu_cgroup_root", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_cgroup_root,
+             test_cpu_tear_down);
+  g_test_add("/cpu/test_cpu_cgroup_missing", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_cgroup_missing,
+             test_cpu_tear_down);
+  g_test_add("/cpu/test_cpu_pool_size", Test_cpu, 0,
+             test_cpu_set_up,
+             test_cpu_pool_size,
+             test_cpu_tear_down);
+
+  return g_test_run();
+}
@@ -0,0 +1,117 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include "heuristic.h"
+
+/* The temporary snapshot path. */
+#define SNAPSHOT_TEST_PATH "./data/test_snapshot.bin"
+/* The position of the connections offset in the snapshot header. */
+#define SNAPSHOT_CONNECTIONS 32
+
+/* Test environment. */
+typedef struct {
+  int seed;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  if (!test_env)
+    return 0;
+  test_env->seed = time(0);
+  srandom(test_env->seed);
+  return test_env;
+}
+
+/* Test database loader. */
+typedef struct {
+  Database_loader* loader;
+  Database_loader* snapshot;
+} Test_loader;
+
+/* Sets up a database loader test case. */
+static void test_loader_set_up(Test_loader* test_loader,
+                               gconstpointer data) {
+  test_loader->loader = loader_new();
+  loader_open(test_loader->loader);
+  loader_load(test_loader->loader);
+  test_loader->snapshot = loader_new();
+}
+
+/* Tears down a database loader test case. */
+static void test_loader_tear_down(Test_loader* test_loader,
+                                  gconstpointer data) {
+  if (test_loader->loader)
+    loader_unref(test_loader->loader);
+  if (test_loader->snapshot)
+    loader_unref(test_loader->snapshot);
+  unlink(SNAPSHOT_TEST_PATH);
+}
+
+/* Tests that a snapshot maps the same database it was written from. */
+static void test_loader_snapshot(Test_loader* test_loader,
+                                 gconstpointer data) {
+  double (*m)[CITY_NUMBER+1], (*s)[CITY_NUMBER+1];
+  City* c, *d;
+  int i, j, k;
+
+  g_assert(loader_write_snapshot(test_loader->loader, SNAPSHOT_TEST_PATH));
+  g_assert(loader_open_snapshot(test_loader->snapshot, SNAPSHOT_TEST_PATH));
+
+  m = loader_adj_matrix(test_loader->loader);
+  s = loader_adj_matrix(test_loader->snapshot);
+  for (k = 0; k < CITY_NUMBER; ++k) {
+    i = random() % CITY_NUMBER + 1;
+    j = random() % CITY_NUMBER + 1;
+    g_assert_cmpfloat(*(*(m+i)+j), ==, *(*(s+i)+j));
+    c = *(loader_cities(test_loader->loader) + i);
+    d = *(loader_cities(test_loader->snapshot) + i);
+    g_assert_cmpint(city_id(c), ==, city_id(d));
+    g_assert_cmpfloat(city_x_coordinate(c), ==, city_x_coordinate(d));
+    g_assert_cmpfloat(city_y_coordinate(c), ==, city_y_coordinate(d));
+  }
+}
+
+/* Tests that a snapshot whose sections lie outside the file is
+   rejected. */
+static void test_loader_snapshot_offsets(Test_loader* test_loader,
+                                         gconstpointer data) {
+  uint64_t offsets[] = { UINT64_MAX - 7, 1 };
+  FILE* file;
+  int i;
+
+  g_assert(loader_write_snapshot(test_loader->loader, SNAPSHOT_TEST_PATH));
+  for (i = 0; i < 2; ++i) {
+    file = fopen(SNAPSHOT_TEST_PATH, "r+b");
+    g_assert(file);
+    fseek(file, SNAPSHOT_CONNECTIONS, SEEK_SET);
+    fwrite(offsets+i, sizeof(uint64_t), 1, file);
+    fclose(file);
+    g_assert(!loader_open_snapshot(test_loader->snapshot,
+                                   SNAPSHOT_TEST_PATH));
+  }
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env *test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/database_loader/test_loader_snapshot", Test_loader, test_env,
+             test_loader_set_up,
+             test_loader_snapshot,
+             test_loader_tear_down);
+  g_test_add("/database_loader/test_loader_snapshot_offsets", Test_loader,
+             test_env,
+             test_loader_set_up,
+             test_loader_snapshot_offsets,
+             test_loader_tear_down);
+  return g_test_run();
+}
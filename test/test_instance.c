@@ -0,0 +1,196 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "heuristic.h"
+
+/* Instance values. */
+#define NUM_CITIES 40
+
+/* Predefined instance. */
+static int instance[40] = {
+  1,2,3,4,5,6,7,54,163,164,165,168,172,186,327,329,331,332,
+  333,483,489,490,491,492,493,496,653,654,656,657,815,816,
+  817,820,978,979,980,981,982,984
+};
+
+/* Test environment. */
+typedef struct {
+  unsigned int seed;
+  Database_loader* loader;
+  Instance* instance;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  test_env->loader = loader_new();
+  loader_open(test_env->loader);
+  loader_load_ids(test_env->loader, NUM_CITIES, instance);
+  test_env->instance = instance_new(test_env->loader, NUM_CITIES,
+                                    instance);
+  test_env->seed = time(0);
+  return test_env;
+}
+
+/* Test instance. */
+typedef struct {
+  Instance* instance;
+  Database_loader* loader;
+} Test_instance;
+
+/* Sets up an instance test case. */
+static void test_instance_set_up(Test_instance* test_instance,
+                                 gconstpointer data) {
+  Test_env* test_env = (Test_env*)data;
+  test_instance->instance = test_env->instance;
+  test_instance->loader = test_env->loader;
+}
+
+/* Tears down an instance test case. */
+static void test_instance_tear_down(Test_instance* test_instance,
+                                    gconstpointer data) {
+}
+
+/* Tests that every pair of cities has its own position in the
+   weight matrix of the layout, and both orders share it when the
+   matrix is packed. */
+static void test_instance_weight_index(Test_instance* test_instance,
+                                       gconstpointer data) {
+#ifdef WEIGHT_PACKED
+  int size = NUM_CITIES*(NUM_CITIES+1)/2;
+#else
+  int size = NUM_CITIES*NUM_CITIES;
+#endif
+  char* seen = calloc(size, 1);
+  int i, j, x;
+
+  for (i = 0; i < NUM_CITIES; ++i)
+    for (j = i; j < NUM_CITIES; ++j) {
+      x = instance_weight_index(NUM_CITIES, i, j);
+      g_assert_cmpint(x, >=, 0);
+      g_assert_cmpint(x, <, size);
+      g_assert_cmpint(*(seen+x), ==, 0);
+      *(seen+x) = 1;
+#ifdef WEIGHT_PACKED
+      g_assert_cmpint(instance_weight_index(NUM_CITIES, j, i), ==, x);
+#endif
+    }
+#ifdef WEIGHT_PACKED
+  /* The upper triangle fills the packed matrix. */
+  g_assert_null(memchr(seen, 0, size));
+#endif
+  free(seen);
+}
+
+/* Tests that the weights are symmetric and positive, and stored
+   at the position of their pair. */
+static void test_instance_weights(Test_instance* test_instance,
+                                  gconstpointer data) {
+  Instance* instance = test_instance->instance;
+  Weight* w = instance_weights(instance);
+  int i, j;
+
+  for (i = 0; i < NUM_CITIES; ++i)
+    for (j = 0; j < NUM_CITIES; ++j) {
+      if (i == j)
+        continue;
+      g_assert_cmpfloat(instance_weight(instance, i, j), >, 0);
+      g_assert_cmpfloat(instance_weight(instance, i, j), ==,
+                        instance_weight(instance, j, i));
+      g_assert_cmpfloat(instance_weight(instance, i, j), ==,
+                        *(w + instance_weight_index(NUM_CITIES, i, j)));
+    }
+}
+
+/* Tests that the candidate list of every city holds its lightest
+   existing edges first, then the lightest missing ones among its
+   nearest cities of the k-d tree, without duplicates nor the city
+   itself. */
+static void test_instance_candidates(Test_instance* test_instance,
+                                     gconstpointer data) {
+  Instance* instance = test_instance->instance;
+  double (*m)[CITY_NUMBER+1] = loader_adj_matrix(test_instance->loader);
+  int* ids = instance_ids(instance);
+  int* candidates = instance_candidates(instance);
+  int k = instance_candidate_number(instance);
+  int* near = malloc(sizeof(int)*(2*k+1));
+  double* distances = malloc(sizeof(double)*(2*k+1));
+  int i, j, x, e, q, *row;
+  char seen[NUM_CITIES], existing;
+  double w, lightest;
+
+  g_assert_cmpint(k, >, 0);
+  for (i = 0; i < NUM_CITIES; ++i) {
+    row = candidates + i*k;
+    memset(seen, 0, NUM_CITIES);
+    for (e = j = 0; j < NUM_CITIES; ++j)
+      e += j != i && *(*(m + *(ids+i)) + *(ids+j)) != 0.0;
+    q = kd_tree_nearest(instance_kd_tree(instance), i, 2*k, near,
+                        distances);
+    for (x = 0; x < k; ++x) {
+      j = *(row+x);
+      g_assert_cmpint(j, >=, 0);
+      g_assert_cmpint(j, <, NUM_CITIES);
+      g_assert_cmpint(j, !=, i);
+      g_assert_cmpint(*(seen+j), ==, 0);
+      *(seen+j) = 1;
+      w = instance_weight(instance, i, j);
+      if (x)
+        g_assert_cmpfloat(instance_weight(instance, i, *(row+x-1)), <=, w);
+      /* The existing edges come first. */
+      existing = *(*(m + *(ids+i)) + *(ids+j)) != 0.0;
+      g_assert_cmpint(existing, ==, x < e);
+    }
+    /* No city left out of the list is lighter than the last one
+       of its kind. */
+    for (j = 0; j < NUM_CITIES; ++j) {
+      if (j == i || *(seen+j))
+        continue;
+      existing = *(*(m + *(ids+i)) + *(ids+j)) != 0.0;
+      if (existing) {
+        g_assert_cmpint(e, >, k);
+        g_assert_cmpfloat(instance_weight(instance, i, j), >=,
+                          instance_weight(instance, i, *(row+k-1)));
+      }
+    }
+    /* The missing edges are the lightest ones of the k-d tree. */
+    lightest = e < k ? instance_weight(instance, i, *(row+k-1)) : 0.;
+    for (x = 0; e < k && x < q; ++x) {
+      j = *(near+x);
+      if (*(*(m + *(ids+i)) + *(ids+j)) != 0.0 || *(seen+j))
+        continue;
+      g_assert_cmpfloat(instance_weight(instance, i, j), >=, lightest);
+    }
+  }
+  free(distances);
+  free(near);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env* test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/instance/test_instance_weight_index", Test_instance,
+             test_env,
+             test_instance_set_up,
+             test_instance_weight_index,
+             test_instance_tear_down);
+  g_test_add("/instance/test_instance_weights", Test_instance, test_env,
+             test_instance_set_up,
+             test_instance_weights,
+             test_instance_tear_down);
+  g_test_add("/instance/test_instance_candidates", Test_instance,
+             test_env,
+             test_instance_set_up,
+             test_instance_candidates,
+             test_instance_tear_down);
+
+  return g_test_run();
+}
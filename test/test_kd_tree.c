@@ -0,0 +1,112 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Test environment. */
+typedef struct {
+  int seed;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  if (!test_env)
+    return 0;
+  test_env->seed = time(0);
+  srandom(test_env->seed);
+  return test_env;
+}
+
+/* Test k-d tree. */
+typedef struct {
+  Database_loader* loader;
+  Kd_tree* tree;
+} Test_kd_tree;
+
+/* Sets up a k-d tree test case. */
+static void test_kd_tree_set_up(Test_kd_tree* test_kd_tree,
+                                gconstpointer data) {
+  test_kd_tree->loader = loader_new();
+  loader_open(test_kd_tree->loader);
+  loader_load(test_kd_tree->loader);
+  test_kd_tree->tree = kd_tree_new(loader_cities(test_kd_tree->loader) + 1,
+                                   CITY_NUMBER);
+}
+
+/* Tears down a k-d tree test case. */
+static void test_kd_tree_tear_down(Test_kd_tree* test_kd_tree,
+                                   gconstpointer data) {
+  if (test_kd_tree->tree)
+    kd_tree_free(test_kd_tree->tree);
+  if (test_kd_tree->loader)
+    loader_free(test_kd_tree->loader);
+}
+
+/* Tests the nearest cities against every pair of cities. */
+static void test_kd_tree_nearest(Test_kd_tree* test_kd_tree,
+                                 gconstpointer data) {
+  City** cities = loader_cities(test_kd_tree->loader) + 1;
+  int nearest[10], i, j, k, c, m = 100;
+  double d, distances[10];
+
+  while (m--) {
+    i = random() % CITY_NUMBER;
+    k = kd_tree_nearest(test_kd_tree->tree, i, 10, nearest, distances);
+    g_assert_cmpint(k, ==, 10);
+    d = city_distance(*(cities+i), *(cities + *(nearest+k-1)));
+    for (j = 1; j < k; ++j)
+      g_assert_cmpfloat(*(distances+j-1), <=, *(distances+j));
+    for (j = 1; j < k; ++j)
+      g_assert_cmpfloat(city_distance(*(cities+i), *(cities + *(nearest+j-1))),
+                        <=, city_distance(*(cities+i), *(cities + *(nearest+j))) + 0.016);
+    for (j = 0, c = 0; j < CITY_NUMBER; ++j)
+      if (j != i && city_distance(*(cities+i), *(cities+j)) < d - 0.016)
+        ++c;
+    g_assert_cmpint(c, <, k);
+  }
+}
+
+/* Tests the cities within a distance against every pair of
+   cities. */
+static void test_kd_tree_radius(Test_kd_tree* test_kd_tree,
+                                gconstpointer data) {
+  City** cities = loader_cities(test_kd_tree->loader) + 1;
+  int* found = malloc(sizeof(int)*CITY_NUMBER);
+  int i, j, k, c, m = 100;
+  double r = 1000000;
+
+  while (m--) {
+    i = random() % CITY_NUMBER;
+    k = kd_tree_radius(test_kd_tree->tree, i, r, found);
+    for (j = 0; j < k; ++j)
+      g_assert_cmpfloat(city_distance(*(cities+i), *(cities + *(found+j))),
+                        <=, r + 0.016);
+    for (j = 0, c = 0; j < CITY_NUMBER; ++j)
+      if (j != i && city_distance(*(cities+i), *(cities+j)) <= r)
+        ++c;
+    g_assert_cmpint(c, ==, k);
+  }
+  free(found);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env *test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/kd_tree/test_kd_tree_nearest", Test_kd_tree, test_env,
+             test_kd_tree_set_up,
+             test_kd_tree_nearest,
+             test_kd_tree_tear_down);
+  g_test_add("/kd_tree/test_kd_tree_radius", Test_kd_tree, test_env,
+             test_kd_tree_set_up,
+             test_kd_tree_radius,
+             test_kd_tree_tear_down);
+  return g_test_run();
+}
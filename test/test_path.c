@@ -38,6 +38,8 @@ static int instance[2][150] = {
 typedef struct {
   unsigned int seed;
   Database_loader* loader;
+  Instance* instance_40;
+  Instance* instance_150;
 } Test_env;
 
 /* Test environment constructor. */
@@ -47,6 +49,10 @@ static Test_env* test_env_new() {
   /* Implement another open method for testing [it fails with meson test] */
   loader_open(test_env->loader);
   loader_load(test_env->loader);
+  test_env->instance_40 = instance_new(test_env->loader, NUM_CITIES_1,
+                                       (int*)instance);
+  test_env->instance_150 = instance_new(test_env->loader, NUM_CITIES_2,
+                                        (int*)instance[1]);
   test_env->seed = time(0);
   srandom(test_env->seed);
   return test_env;
@@ -62,13 +68,8 @@ typedef struct {
 static void test_path_set_up(Test_path* test_path,
                              gconstpointer data) {
   Test_env* test_env = (Test_env*)data;
-  Database_loader* loader = test_env->loader;
-  test_path->path_40 = path_new(loader_cities(loader),
-                                NUM_CITIES_1, (int*)instance,
-                                test_env->seed, loader_adj_matrix(loader));
-  test_path->path_150 = path_new(loader_cities(loader),
-                                 NUM_CITIES_2, (int*)instance[1],
-                                 test_env->seed, loader_adj_matrix(loader));
+  test_path->path_40 = path_new(test_env->instance_40, test_env->seed);
+  test_path->path_150 = path_new(test_env->instance_150, test_env->seed);
 }
 
 /* Tears down a city test case. */
@@ -160,6 +161,89 @@ static void test_path_de_swap(Test_path* test_path,
   }
 }
 
+/* Tests the segment reversal. */
+static void test_path_two_opt(Test_path* test_path,
+                              gconstpointer data) {
+  int n = NUM_CITIES_1 * NUM_CITIES_1, m = NUM_CITIES_2 * NUM_CITIES_2;
+  int i, j;
+  long double delta;
+  Path* copy;
+  path_randomize(test_path->path_40);
+  while (n--) {
+    copy = path_copy(test_path->path_40);
+    path_random_swap(test_path->path_40, &i, &j);
+    delta = path_two_opt_delta(test_path->path_40, i, j);
+    path_two_opt_commit(test_path->path_40, i, j, delta);
+    g_assert_cmpfloat_with_epsilon(path_cost_function(test_path->path_40),
+                                   path_cost_sum(test_path->path_40)/
+                                   path_normalize(test_path->path_40),
+                                   0.00016);
+    path_two_opt_commit(test_path->path_40, i, j, -delta);
+    g_assert(path_cmp(test_path->path_40, copy));
+    path_free(copy);
+  }
+
+  path_randomize(test_path->path_150);
+  while (m--) {
+    copy = path_copy(test_path->path_150);
+    path_random_swap(test_path->path_150, &i, &j);
+    delta = path_two_opt_delta(test_path->path_150, i, j);
+    path_two_opt_commit(test_path->path_150, i, j, delta);
+    g_assert_cmpfloat_with_epsilon(path_cost_function(test_path->path_150),
+                                   path_cost_sum(test_path->path_150)/
+                                   path_normalize(test_path->path_150),
+                                   0.00016);
+    path_two_opt_commit(test_path->path_150, i, j, -delta);
+    g_assert(path_cmp(test_path->path_150, copy));
+    path_free(copy);
+  }
+}
+
+/* Tests the segment exchange, alternating Or-opt and 3-opt
+   moves. */
+static void test_path_three_opt(Test_path* test_path,
+                                gconstpointer data) {
+  int n = NUM_CITIES_1 * NUM_CITIES_1, m = NUM_CITIES_2 * NUM_CITIES_2;
+  int i, j, k;
+  long double delta;
+  Path* copy;
+  path_randomize(test_path->path_40);
+  while (n--) {
+    copy = path_copy(test_path->path_40);
+    if (n % 2)
+      path_random_or_opt(test_path->path_40, &i, &j, &k);
+    else
+      path_random_three_opt(test_path->path_40, &i, &j, &k);
+    delta = path_three_opt_delta(test_path->path_40, i, j, k);
+    path_three_opt_commit(test_path->path_40, i, j, k, delta);
+    g_assert_cmpfloat_with_epsilon(path_cost_function(test_path->path_40),
+                                   path_cost_sum(test_path->path_40)/
+                                   path_normalize(test_path->path_40),
+                                   0.00016);
+    path_three_opt_commit(test_path->path_40, i, i+k-j+1, k, -delta);
+    g_assert(path_cmp(test_path->path_40, copy));
+    path_free(copy);
+  }
+
+  path_randomize(test_path->path_150);
+  while (m--) {
+    copy = path_copy(test_path->path_150);
+    if (m % 2)
+      path_random_or_opt(test_path->path_150, &i, &j, &k);
+    else
+      path_random_three_opt(test_path->path_150, &i, &j, &k);
+    delta = path_three_opt_delta(test_path->path_150, i, j, k);
+    path_three_opt_commit(test_path->path_150, i, j, k, delta);
+    g_assert_cmpfloat_with_epsilon(path_cost_function(test_path->path_150),
+                                   path_cost_sum(test_path->path_150)/
+                                   path_normalize(test_path->path_150),
+                                   0.00016);
+    path_three_opt_commit(test_path->path_150, i, i+k-j+1, k, -delta);
+    g_assert(path_cmp(test_path->path_150, copy));
+    path_free(copy);
+  }
+}
+
 int main(int argc, char** argv) {
   setlocale(LC_ALL, "");
   g_test_init(&argc, &argv, NULL);
@@ -186,6 +270,14 @@ int main(int argc, char** argv) {
              test_path_set_up,
              test_path_de_swap,
              test_path_tear_down);
+  g_test_add("/path/test_path_two_opt", Test_path, test_env,
+             test_path_set_up,
+             test_path_two_opt,
+             test_path_tear_down);
+  g_test_add("/path/test_path_three_opt", Test_path, test_env,
+             test_path_set_up,
+             test_path_three_opt,
+             test_path_tear_down);
 
   return g_test_run();
 }
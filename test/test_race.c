@@ -0,0 +1,114 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "heuristic.h"
+
+/* Race values. */
+#define SEEDS    8
+#define QUANTILE 0.5
+#define INTERVAL 4
+#define EPSILON  0.000016
+#define PHI      0.98
+#define FIRST    40
+#define COLD     10
+
+/* Test race. */
+typedef struct {
+  Race* race;
+} Test_race;
+
+/* Sets up a race test case, with three peers at a cold
+   checkpoint. */
+static void test_race_set_up(Test_race* test_race, gconstpointer data) {
+  Race* race = race_new(SEEDS, QUANTILE, INTERVAL);
+  test_race->race = race;
+  g_assert_cmpint(race_check(race, COLD, FIRST, 0.30), ==, 0);
+  g_assert_cmpint(race_check(race, COLD, FIRST, 0.29), ==, 0);
+  g_assert_cmpint(race_check(race, COLD, FIRST, 0.31), ==, 0);
+}
+
+/* Tears down a race test case. */
+static void test_race_tear_down(Test_race* test_race, gconstpointer data) {
+  race_free(test_race->race);
+}
+
+/* Tests that the checkpoints are temperatures of the schedule,
+   counted up from epsilon. */
+static void test_race_checkpoint(Test_race* test_race,
+                                 gconstpointer data) {
+  Race* race = test_race->race;
+  long double t;
+  int c;
+
+  for (c = 0; c < FIRST; ++c) {
+    /* The middle of the cooling steps of the checkpoint. */
+    t = EPSILON / powl(PHI, INTERVAL*c + INTERVAL/2.);
+    g_assert_cmpint(race_checkpoint(race, t, EPSILON, PHI), ==, c);
+  }
+  g_assert_cmpint(race_checkpoint(race, EPSILON/2, EPSILON, PHI), ==, -1);
+}
+
+/* Tests that a seed within the noise of its peers is not cut. */
+static void test_race_noise(Test_race* test_race, gconstpointer data) {
+  g_assert_cmpint(race_check(test_race->race, COLD, FIRST, 0.31), ==, 0);
+}
+
+/* Tests that a seed clearly worse than its peers is cut. */
+static void test_race_worse(Test_race* test_race, gconstpointer data) {
+  g_assert_cmpint(race_check(test_race->race, COLD, FIRST, 0.40), ==, 1);
+}
+
+/* Tests that a seed is not cut in the warm half of its cooling. */
+static void test_race_warm(Test_race* test_race, gconstpointer data) {
+  Race* race = test_race->race;
+  int c = FIRST/2 + 1;
+
+  g_assert_cmpint(race_check(race, c, FIRST, 0.30), ==, 0);
+  g_assert_cmpint(race_check(race, c, FIRST, 0.29), ==, 0);
+  g_assert_cmpint(race_check(race, c, FIRST, 0.31), ==, 0);
+  g_assert_cmpint(race_check(race, c, FIRST, 0.90), ==, 0);
+}
+
+/* Tests that a seed is only compared with the peers of its own
+   checkpoint, and only if there are enough of them. */
+static void test_race_peers(Test_race* test_race, gconstpointer data) {
+  Race* race = test_race->race;
+
+  /* The peers of another checkpoint do not count. */
+  g_assert_cmpint(race_check(race, COLD-1, FIRST, 0.90), ==, 0);
+  g_assert_cmpint(race_check(race, COLD-1, FIRST, 0.91), ==, 0);
+  g_assert_cmpint(race_check(race, COLD-1, FIRST, 0.92), ==, 0);
+  g_assert_cmpint(race_check(race, COLD-1, FIRST, 0.40), ==, 0);
+  g_assert_cmpint(race_check(race, COLD-1, FIRST, 1.50), ==, 1);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add("/race/test_race_checkpoint", Test_race, 0,
+             test_race_set_up,
+             test_race_checkpoint,
+             test_race_tear_down);
+  g_test_add("/race/test_race_noise", Test_race, 0,
+             test_race_set_up,
+             test_race_noise,
+             test_race_tear_down);
+  g_test_add("/race/test_race_worse", Test_race, 0,
+             test_race_set_up,
+             test_race_worse,
+             test_race_tear_down);
+  g_test_add("/race/test_race_warm", Test_race, 0,
+             test_race_set_up,
+             test_race_warm,
+             test_race_tear_down);
+  g_test_add("/race/test_race_peers", Test_race, 0,
+             test_race_set_up,
+             test_race_peers,
+             test_race_tear_down);
+
+  return g_test_run();
+}
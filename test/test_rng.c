@@ -0,0 +1,102 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Test environment. */
+typedef struct {
+  int seed;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  if (!test_env)
+    return 0;
+  test_env->seed = time(0);
+  srandom(test_env->seed);
+  return test_env;
+}
+
+#define DRAWS 100000
+
+/* Test random number generator. */
+typedef struct {
+  Rng rng;
+} Test_rng;
+
+/* Sets up a random number generator test case. */
+static void test_rng_set_up(Test_rng* test_rng,
+                            gconstpointer data) {
+  rng_seed(&test_rng->rng, random());
+}
+
+/* Tears down a random number generator test case. */
+static void test_rng_tear_down(Test_rng* test_rng,
+                               gconstpointer data) {
+}
+
+/* Tests that the bounded integers are in range and close to
+   uniform. */
+static void test_rng_bounded(Test_rng* test_rng,
+                             gconstpointer data) {
+  int count[7] = { 0 }, i;
+  for (i = 0; i < DRAWS; ++i) {
+    uint32_t r = rng_bounded(&test_rng->rng, 7);
+    g_assert_cmpuint(r, <, 7);
+    ++*(count+r);
+  }
+  for (i = 0; i < 7; ++i)
+    g_assert_cmpint(abs(*(count+i) - DRAWS/7), <, DRAWS/70);
+}
+
+/* Tests that the pairs are distinct and ordered. */
+static void test_rng_pairs(Test_rng* test_rng,
+                           gconstpointer data) {
+  int i[64], j[64], c, m = DRAWS/64;
+  while (m--) {
+    rng_pairs(&test_rng->rng, 2 + m%40, i, j, 64);
+    for (c = 0; c < 64; ++c) {
+      g_assert_cmpint(*(i+c), <, *(j+c));
+      g_assert_cmpint(*(j+c), <, 2 + m%40);
+    }
+  }
+}
+
+/* Tests that consecutive seeds are separated by a jump. */
+static void test_rng_jump(Test_rng* test_rng,
+                          gconstpointer data) {
+  Rng a, b;
+  rng_seed(&a, RNG_STREAMS);
+  rng_seed(&b, RNG_STREAMS+1);
+  g_assert_cmpuint(rng_next(&a), !=, rng_next(&b));
+  rng_seed(&a, RNG_STREAMS);
+  rng_jump(&a);
+  rng_seed(&b, RNG_STREAMS+1);
+  g_assert_cmpuint(rng_next(&a), ==, rng_next(&b));
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env *test_env = test_env_new();
+  printf("Seed: %d", test_env->seed);
+
+  g_test_add("/rng/test_rng_bounded", Test_rng, test_env,
+             test_rng_set_up,
+             test_rng_bounded,
+             test_rng_tear_down);
+  g_test_add("/rng/test_rng_pairs", Test_rng, test_env,
+             test_rng_set_up,
+             test_rng_pairs,
+             test_rng_tear_down);
+  g_test_add("/rng/test_rng_jump", Test_rng, test_env,
+             test_rng_set_up,
+             test_rng_jump,
+             test_rng_tear_down);
+  return g_test_run();
+}
@@ -0,0 +1,176 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "heuristic.h"
+
+/* Instance values. */
+#define NUM_CITIES 150
+#define PHI        0.98
+#define LIMIT      0.5
+#define SWEEPS     100
+
+/* Predefined instance. */
+static int instance[150] = {
+  1,2,3,4,5,6,7,8,9,11,12,14,16,17,19,20,22,23,25,26,54,74,75,
+  77,151,163,164,165,166,167,168,169,171,172,173,174,176,179,181,
+  182,183,184,185,186,187,190,191,297,326,327,328,329,330,331,332,
+  333,334,336,339,340,343,344,345,346,347,349,350,351,352,444,483,
+  489,490,491,492,493,494,495,496,499,500,501,502,504,505,507,508,
+  509,510,511,512,520,652,653,654,655,656,657,658,660,661,662,663,
+  665,666,667,668,670,671,673,674,675,676,678,680,815,816,817,818,
+  819,820,821,822,823,825,826,828,829,832,837,840,978,979,980,981,
+  982,984,985,986,988,990,991,995,999,1001,1003,1037,1038,1073,1075
+};
+
+/* Test environment. */
+typedef struct {
+  unsigned int seed;
+  Database_loader* loader;
+  Instance* instance;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  test_env->loader = loader_new();
+  loader_open(test_env->loader);
+  loader_load_ids(test_env->loader, NUM_CITIES, instance);
+  test_env->instance = instance_new(test_env->loader, NUM_CITIES,
+                                    instance);
+  test_env->seed = time(0);
+  return test_env;
+}
+
+/* Test simulated annealing. */
+typedef struct {
+  TSP* tsp;
+} Test_sa;
+
+/* Sets up a simulated annealing test case. */
+static void test_sa_set_up(Test_sa* test_sa, gconstpointer data) {
+  Test_env* test_env = (Test_env*)data;
+  test_sa->tsp = tsp_new(test_env->instance, test_env->seed);
+}
+
+/* Tears down a simulated annealing test case. */
+static void test_sa_tear_down(Test_sa* test_sa, gconstpointer data) {
+  if (test_sa->tsp)
+    tsp_free(test_sa->tsp);
+}
+
+/* Checks that a path is a permutation whose cost sum matches a
+   full recomputation. The sum is updated with deltas, so it keeps
+   the rounding errors of the larger sums it started from. */
+static void check_path(Path* path, double start) {
+  char seen[NUM_CITIES];
+  int* ids = path_ids(path);
+  int i;
+
+  memset(seen, 0, NUM_CITIES);
+  for (i = 0; i < NUM_CITIES; ++i) {
+    g_assert_cmpint(*(ids+i), >=, 0);
+    g_assert_cmpint(*(ids+i), <, NUM_CITIES);
+    g_assert_cmpint(*(seen + *(ids+i)), ==, 0);
+    *(seen + *(ids+i)) = 1;
+  }
+  g_assert_cmpfloat_with_epsilon(path_sum(path), path_cost_sum(path),
+                                 start*1e-12);
+}
+
+/* Tests the parallel sweep from a random path, with every
+   neighbourhood, with and without the two-level tour. */
+static void test_sa_parallel_sweep(Test_sa* test_sa,
+                                   gconstpointer data) {
+  Path* path = tsp_path(test_sa->tsp);
+  Neighbourhood nb;
+  long double before;
+  double start;
+  SA* sa;
+  int tour;
+
+  for (nb = NEIGHBOURHOOD_SWAP; nb <= NEIGHBOURHOOD_THREE_OPT; ++nb)
+    for (tour = 0; tour < 2; ++tour) {
+      sa = sa_new(test_sa->tsp, 1, 0, 0, 0, 0, 0, 0, 0, nb);
+      sa_set_sweep(sa, 0, 0, 0., 4);
+      sa_set_sweep_tour(sa, tour);
+      before = path_cost_function(path);
+      start = path_sum(path);
+      sweep(sa);
+      check_path(path, start);
+      g_assert_cmpfloat(path_cost_function(path), <, before);
+      sa_free(sa);
+    }
+}
+
+/* Tests that the don't-look bits of a sweep empty its queue: a
+   sweep never worsens the path and, since it only wakes up the
+   ends of the changed edges, a few more sweeps, which wake up
+   every city again, reach a path where a whole sweep finds no
+   move. */
+static void test_sa_dont_look(Test_sa* test_sa, gconstpointer data) {
+  Path* path = tsp_path(test_sa->tsp);
+  Neighbourhood nb;
+  long double before;
+  SA* sa;
+  int j, rounds;
+
+  for (nb = NEIGHBOURHOOD_SWAP; nb <= NEIGHBOURHOOD_THREE_OPT; ++nb)
+    for (j = 1; j <= 4; j += 3) {
+      sa = sa_new(test_sa->tsp, 1, 0, 0, 0, 0, 0, 0, 0, nb);
+      sa_set_sweep(sa, 0, 0, 0., j);
+      rounds = 0;
+      do {
+        before = path_cost_function(path);
+        sweep(sa);
+        g_assert_cmpfloat(path_cost_function(path), <=, before);
+      } while (path_cost_function(path) < before && ++rounds < SWEEPS);
+      g_assert_cmpint(rounds, <, SWEEPS);
+      sa_free(sa);
+    }
+}
+
+/* Tests that a run with the default parameters, far too long
+   for the time limit, ends within it by lowering phi. */
+static void test_sa_time_limit(Test_sa* test_sa, gconstpointer data) {
+  SA* sa = sa_new(test_sa->tsp, 0, 0, 0, 0, PHI, 0, 0, 0,
+                  NEIGHBOURHOOD_SWAP);
+  double start;
+
+  sa_set_time_limit(sa, LIMIT);
+  start = wall_clock_seconds();
+  threshold_accepting(sa);
+  /* A batch and a few cities of the sweep may overrun it. */
+  g_assert_cmpfloat(wall_clock_seconds() - start, <, LIMIT*1.2);
+  g_assert_cmpfloat(sa_phi(sa), <, PHI);
+  /* The sweep of the rest of the time only improves the best. */
+  g_assert_cmpfloat(path_cost_function(tsp_path(test_sa->tsp)), <=,
+                    path_cost_function(sa_best(sa)));
+  sa_free(sa);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env* test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/sa/test_sa_parallel_sweep", Test_sa, test_env,
+             test_sa_set_up,
+             test_sa_parallel_sweep,
+             test_sa_tear_down);
+  g_test_add("/sa/test_sa_dont_look", Test_sa, test_env,
+             test_sa_set_up,
+             test_sa_dont_look,
+             test_sa_tear_down);
+  g_test_add("/sa/test_sa_time_limit", Test_sa, test_env,
+             test_sa_set_up,
+             test_sa_time_limit,
+             test_sa_tear_down);
+
+  return g_test_run();
+}
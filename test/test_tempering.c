@@ -0,0 +1,148 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "heuristic.h"
+
+/* Instance values. */
+#define NUM_CITIES 40
+#define REPLICAS   4
+#define ROUNDS     20
+#define T_HOT      1000000.
+#define EPSILON    0.002
+#define PHI        0.95
+
+/* Predefined instance. */
+static int instance[40] = {
+  1,2,3,4,5,6,7,54,163,164,165,168,172,186,327,329,331,332,
+  333,483,489,490,491,492,493,496,653,654,656,657,815,816,
+  817,820,978,979,980,981,982,984
+};
+
+/* Test environment. */
+typedef struct {
+  unsigned int seed;
+  Database_loader* loader;
+  Instance* instance;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  test_env->loader = loader_new();
+  loader_open(test_env->loader);
+  loader_load_ids(test_env->loader, NUM_CITIES, instance);
+  test_env->instance = instance_new(test_env->loader, NUM_CITIES,
+                                    instance);
+  test_env->seed = time(0);
+  return test_env;
+}
+
+/* Test parallel tempering. */
+typedef struct {
+  Tempering* tempering;
+} Test_tempering;
+
+/* Sets up a parallel tempering test case. */
+static void test_tempering_set_up(Test_tempering* test_tempering,
+                                  gconstpointer data) {
+  Test_env* test_env = (Test_env*)data;
+  test_tempering->tempering =
+    tempering_new(test_env->instance, test_env->seed, REPLICAS, ROUNDS,
+                  T_HOT, 1000, 100, EPSILON, PHI, 0, 0, 0,
+                  NEIGHBOURHOOD_TWO_OPT);
+}
+
+/* Tears down a parallel tempering test case. */
+static void test_tempering_tear_down(Test_tempering* test_tempering,
+                                     gconstpointer data) {
+  if (test_tempering->tempering)
+    tempering_free(test_tempering->tempering);
+}
+
+/* Tests that the ladder decreases geometrically from the hottest
+   temperature to the one the annealing reaches some cooling steps
+   before epsilon. */
+static void test_tempering_ladder(Test_tempering* test_tempering,
+                                  gconstpointer data) {
+  Tempering* tempering = test_tempering->tempering;
+  double cold = EPSILON/pow(PHI, TEMPERING_COLD_STEPS);
+  double ratio = pow(cold/T_HOT, 1./(REPLICAS-1));
+  int k;
+
+  g_assert_cmpfloat_with_epsilon(tempering_temperature(tempering, 0),
+                                 T_HOT, 1e-6);
+  g_assert_cmpfloat_with_epsilon(tempering_temperature(tempering,
+                                                       REPLICAS-1),
+                                 cold, 1e-9);
+  for (k = 1; k < REPLICAS; ++k)
+    g_assert_cmpfloat_with_epsilon(tempering_temperature(tempering, k)/
+                                   tempering_temperature(tempering, k-1),
+                                   ratio, 1e-9);
+}
+
+/* Tests that the exchanges keep every replica at the temperature
+   of its position in the ladder. */
+static void test_tempering_exchange(Test_tempering* test_tempering,
+                                    gconstpointer data) {
+  Tempering* tempering = test_tempering->tempering;
+  int seen[REPLICAS] = { 0 }, k, j;
+
+  tempering_run(tempering);
+  g_assert_cmpint(tempering_exchanges(tempering), >, 0);
+  for (k = 0; k < REPLICAS; ++k) {
+    j = tempering_replica(tempering, k);
+    g_assert_cmpint(j, >=, 0);
+    g_assert_cmpint(j, <, REPLICAS);
+    g_assert_cmpint(*(seen+j), ==, 0);
+    *(seen+j) = 1;
+    g_assert_cmpfloat(sa_temperature(tempering_sa(tempering, j)), ==,
+                      tempering_temperature(tempering, k));
+  }
+}
+
+/* Tests that the replica at the coldest rung ends better than
+   every random solution the replicas started from. */
+static void test_tempering_cold(Test_tempering* test_tempering,
+                                gconstpointer data) {
+  Tempering* tempering = test_tempering->tempering;
+  long double start, cost;
+  int j;
+
+  start = path_cost_function(sa_best(tempering_sa(tempering, 0)));
+  for (j = 1; j < REPLICAS; ++j) {
+    cost = path_cost_function(sa_best(tempering_sa(tempering, j)));
+    start = cost < start ? cost : start;
+  }
+  tempering_run(tempering);
+  j = tempering_replica(tempering, REPLICAS-1);
+  g_assert_cmpfloat(path_cost_function(sa_best(tempering_sa(tempering, j))),
+                    <, start);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env* test_env = test_env_new();
+  printf("Seed: %d\n", test_env->seed);
+
+  g_test_add("/tempering/test_tempering_ladder", Test_tempering, test_env,
+             test_tempering_set_up,
+             test_tempering_ladder,
+             test_tempering_tear_down);
+  g_test_add("/tempering/test_tempering_exchange", Test_tempering,
+             test_env,
+             test_tempering_set_up,
+             test_tempering_exchange,
+             test_tempering_tear_down);
+  g_test_add("/tempering/test_tempering_cold", Test_tempering, test_env,
+             test_tempering_set_up,
+             test_tempering_cold,
+             test_tempering_tear_down);
+
+  return g_test_run();
+}
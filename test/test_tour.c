@@ -0,0 +1,100 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Test environment. */
+typedef struct {
+  int seed;
+} Test_env;
+
+/* Test environment constructor. */
+static Test_env* test_env_new() {
+  Test_env *test_env = malloc(sizeof(Test_env));
+  if (!test_env)
+    return 0;
+  test_env->seed = time(0);
+  srandom(test_env->seed);
+  return test_env;
+}
+
+#define NUM_CITIES 150
+
+/* Test tour. */
+typedef struct {
+  int* ids;
+  Tour* tour;
+} Test_tour;
+
+/* Sets up a tour test case, with a random order. */
+static void test_tour_set_up(Test_tour* test_tour,
+                             gconstpointer data) {
+  int i, r, temp;
+  test_tour->ids = malloc(sizeof(int)*NUM_CITIES);
+  for (i = 0; i < NUM_CITIES; ++i)
+    *(test_tour->ids+i) = i;
+  for (i = NUM_CITIES-1; i > 0; --i) {
+    r = random() % (i+1);
+    temp = *(test_tour->ids+i);
+    *(test_tour->ids+i) = *(test_tour->ids+r);
+    *(test_tour->ids+r) = temp;
+  }
+  test_tour->tour = tour_new(test_tour->ids, NUM_CITIES);
+}
+
+/* Tears down a tour test case. */
+static void test_tour_tear_down(Test_tour* test_tour,
+                                gconstpointer data) {
+  if (test_tour->tour)
+    tour_free(test_tour->tour);
+  free(test_tour->ids);
+}
+
+/* Tests the reversals against the ones of an array. */
+static void test_tour_reverse(Test_tour* test_tour,
+                              gconstpointer data) {
+  int* ids = test_tour->ids, *array = malloc(sizeof(int)*NUM_CITIES);
+  int i, j, p, temp, m = NUM_CITIES * NUM_CITIES;
+
+  while (m--) {
+    i = random() % NUM_CITIES;
+    j = random() % NUM_CITIES;
+    tour_reverse(test_tour->tour, i, j);
+    if (i > j)
+      temp = i, i = j, j = temp;
+    for (; i < j; ++i, --j) {
+      temp = *(ids+i);
+      *(ids+i) = *(ids+j);
+      *(ids+j) = temp;
+    }
+    p = random() % NUM_CITIES;
+    g_assert_cmpint(tour_city(test_tour->tour, p), ==, *(ids+p));
+    g_assert_cmpint(tour_position(test_tour->tour, *(ids+p)), ==, p);
+    if (p+1 < NUM_CITIES)
+      g_assert_cmpint(tour_next(test_tour->tour, *(ids+p)), ==, *(ids+p+1));
+    if (p)
+      g_assert_cmpint(tour_prev(test_tour->tour, *(ids+p)), ==, *(ids+p-1));
+  }
+
+  tour_to_array(test_tour->tour, array);
+  for (i = 0; i < NUM_CITIES; ++i)
+    g_assert_cmpint(*(array+i), ==, *(ids+i));
+  free(array);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  Test_env *test_env = test_env_new();
+  printf("Seed: %d", test_env->seed);
+
+  g_test_add("/tour/test_tour_reverse", Test_tour, test_env,
+             test_tour_set_up,
+             test_tour_reverse,
+             test_tour_tear_down);
+  return g_test_run();
+}
@@ -0,0 +1,63 @@
+#include <glib.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "heuristic.h"
+
+/* Time values. */
+#define REST 12.
+
+/* Test wall clock. */
+typedef struct {
+  double now;
+} Test_wall_clock;
+
+/* Sets up a wall clock test case. */
+static void test_wall_clock_set_up(Test_wall_clock* test_wall_clock,
+                                   gconstpointer data) {
+  test_wall_clock->now = wall_clock_seconds();
+}
+
+/* Tears down a wall clock test case. */
+static void test_wall_clock_tear_down(Test_wall_clock* test_wall_clock,
+                                      gconstpointer data) {
+}
+
+/* Tests that the time left is divided by the rounds of seeds a
+   worker still runs. */
+static void test_wall_clock_share(Test_wall_clock* test_wall_clock,
+                                  gconstpointer data) {
+  double end = test_wall_clock->now + REST;
+
+  g_assert_cmpfloat_with_epsilon(wall_clock_share(end, 1, 4), REST, 0.1);
+  g_assert_cmpfloat_with_epsilon(wall_clock_share(end, 4, 4), REST, 0.1);
+  g_assert_cmpfloat_with_epsilon(wall_clock_share(end, 5, 4), REST/2, 0.1);
+  g_assert_cmpfloat_with_epsilon(wall_clock_share(end, 5, 2), REST/3, 0.1);
+  g_assert_cmpfloat_with_epsilon(wall_clock_share(end, 6, 1), REST/6, 0.1);
+}
+
+/* Tests that a run past its end still gets a positive share. */
+static void test_wall_clock_share_late(Test_wall_clock* test_wall_clock,
+                                       gconstpointer data) {
+  double end = test_wall_clock->now - REST;
+
+  g_assert_cmpfloat(wall_clock_share(end, 3, 2), >, 0.);
+  g_assert_cmpfloat(wall_clock_share(end, 3, 2), <, 1e-6);
+}
+
+int main(int argc, char** argv) {
+  setlocale(LC_ALL, "");
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add("/wall_clock/test_wall_clock_share", Test_wall_clock, 0,
+             test_wall_clock_set_up,
+             test_wall_clock_share,
+             test_wall_clock_tear_down);
+  g_test_add("/wall_clock/test_wall_clock_share_late", Test_wall_clock, 0,
+             test_wall_clock_set_up,
+             test_wall_clock_share_late,
+             test_wall_clock_tear_down);
+
+  return g_test_run();
+}